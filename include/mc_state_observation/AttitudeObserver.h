@@ -34,7 +34,10 @@ public:
     double linearAccCov = 1e-13;
     double stateCov = 3e-14;
     double stateInitCov = 1e-8;
+    bool analyticalJacobians = true; ///< Use the analytical Jacobians instead of the finite differences
     Eigen::Matrix3d offset = Eigen::Matrix3d::Identity(); ///< Offset to apply to the estimation result
+    /// Returns true if the covariances of the process or of the measurements differ from the ones of @p other
+    bool covariancesDiffer(const KalmanFilterConfig & other) const;
     void addToLogger(mc_rtc::Logger & logger, const std::string & category);
     void removeFromLogger(mc_rtc::Logger & logger, const std::string & category);
     void addToGUI(mc_rtc::gui::StateBuilder & gui, const std::vector<std::string> & category);
@@ -42,6 +45,15 @@ public:
   };
 
 protected:
+  /// @brief Builds the covariance matrices of the process and of the measurements from the configuration and gives
+  /// them to the filter.
+  void setFilterCovariances(const KalmanFilterConfig & c);
+
+  /// @brief Computes the Jacobians of the state and measurement dynamics of the IMU for the current estimate and input.
+  /// @details Only the blocks depending on the orientation are computed, the other ones are constant and set in the
+  /// constructor.
+  void computeJacobians();
+
   /*! \brief Add observer from logger
    *
    * @param category Category in which to log this observer
@@ -80,6 +92,8 @@ protected:
   static constexpr unsigned INPUT_SIZE = 6;
 
   double lastStateInitCovariance_;
+  /// Configuration whose covariances are currently used by the filter
+  KalmanFilterConfig filterCovariancesConfig_;
 
   /// initialization of the extended Kalman filter
   stateObservation::ExtendedKalmanFilter filter_;
@@ -90,6 +104,10 @@ protected:
   stateObservation::Matrix q_;
   stateObservation::Matrix r_;
 
+  /// Jacobians of the state (a_) and measurement (c_) dynamics, allocated once
+  stateObservation::Matrix a_;
+  stateObservation::Matrix c_;
+
   stateObservation::Vector uk_;
   stateObservation::Vector xk_;
 
@@ -117,6 +135,7 @@ struct ConfigurationLoader<mc_state_observation::AttitudeObserver::KalmanFilterC
     config("lin_acc_cov", c.linearAccCov);
     config("state_cov", c.stateCov);
     config("state_init_cov", c.stateInitCov);
+    config("analytical_jacobians", c.analyticalJacobians);
     return c;
   }
   static mc_rtc::Configuration save(const mc_state_observation::AttitudeObserver::KalmanFilterConfig & c)
@@ -130,6 +149,7 @@ struct ConfigurationLoader<mc_state_observation::AttitudeObserver::KalmanFilterC
     config.add("lin_acc_cov", c.linearAccCov);
     config.add("state_cov", c.stateCov);
     config.add("state_init_cov", c.stateInitCov);
+    config.add("analytical_jacobians", c.analyticalJacobians);
     return config;
   }
 };
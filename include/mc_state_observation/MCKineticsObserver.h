@@ -2,15 +2,25 @@
 
 #pragma once
 
-#include <boost/circular_buffer.hpp>
-
 #include "mc_state_observation/TiltObserver.h"
+#include <mc_state_observation/checkpoint/Checkpoint.h>
+#include <mc_state_observation/concurrency/AsyncWorker.h>
+#include <mc_state_observation/concurrency/DoubleBuffer.h>
 #include <mc_state_observation/measurements/ContactsManager.h>
 #include <mc_state_observation/measurements/measurements.h>
+#include <mc_state_observation/pipeline/KinematicsCache.h>
+#include <mc_state_observation/profiling/AllocationTracking.h>
+#include <mc_state_observation/profiling/LatencyHistogram.h>
 #include <state-observation/dynamics-estimators/kinetics-observer.hpp>
 
+#include <limits>
+
 namespace mc_state_observation
 {
+/// @brief Iteration stamp of the debug values that were not computed since the last reset. Never equal to the index of
+/// an iteration.
+inline constexpr size_t koInvalidIter = std::numeric_limits<size_t>::max();
+
 /** Interface for the use of the Kinetics Observer within mc_rtc: \n
  * The Kinetics Observer requires inputs expressed in the frame of the floating base. It then performs a conversion to
  *the centroid frame, a frame located at the center of mass of the robot and with the orientation of the floating
@@ -40,18 +50,54 @@ public:
   Eigen::Matrix<double, 6, 1> contactWrenchVector_;
   // contact wrench expressed in the centroid frame. Used for logs.
   Eigen::Matrix<double, 6, 1> wrenchInCentroid_ = Eigen::Matrix<double, 6, 1>::Zero();
-  // for debug only
-  stateObservation::Vector6 viscoElasticWrenchAfterCorrection_;
+  // for debug only. Computed on demand, see MCKineticsObserver::viscoElasticWrenchAfterCorrection.
+  mutable stateObservation::Vector6 viscoElasticWrenchAfterCorrection_;
+  // iteration at which viscoElasticWrenchAfterCorrection_ was computed
+  mutable size_t viscoElasticWrenchIter_ = koInvalidIter;
 
   // the sensor measurement has to be used by the observer
   bool sensorEnabled_ = true;
 };
 
+/// @brief Absolute measurement of the pose of the floating base in the world received with a delay (SLAM, motion
+/// capture).
+struct KoDelayedPoseMeasurement
+{
+  // measured pose of the floating base in the world on the iteration of the measurement
+  stateObservation::kine::Kinematics worldFbKine;
+  // number of iterations elapsed between the measurement and its reception
+  unsigned long delay = 0;
+  // if false, only the orientation is measured
+  bool withPosition = true;
+  // true if the measurement was received and is not given to the Kinetics Observer yet
+  bool pending = false;
+};
+
+/// @brief Results of an update of the Kinetics Observer.
+/// @details In the asynchronous mode, they are written by the worker thread and read on the next iteration by the
+/// control thread.
+struct KoUpdateResults
+{
+  // estimated kinematics of the floating base in the world frame
+  stateObservation::kine::Kinematics worldFbKine;
+  // estimated state vector
+  stateObservation::Vector stateVector;
+  // diagonal of the state covariance matrix. Retrieved only if the debug logs are enabled.
+  stateObservation::Vector stateCovarianceDiagonal;
+  // indicates if a NaN was detected during the update
+  bool nanDetected = false;
+  // computation time (s) of the update
+  double updateDuration = 0.0;
+};
+
 struct MCKineticsObserver : public mc_observers::Observer
 {
 
   MCKineticsObserver(const std::string & type, double dt);
 
+  /// @brief Destructor. Saves the state of the Kinetics Observer and of its backup in the checkpoint file, if any.
+  ~MCKineticsObserver() override;
+
   void configure(const mc_control::MCController & ctl, const mc_rtc::Configuration &) override;
 
   void reset(const mc_control::MCController & ctl) override;
@@ -61,13 +107,31 @@ struct MCKineticsObserver : public mc_observers::Observer
   void update(mc_control::MCController & ctl) override;
 
 protected:
+  /// @brief Builds again the Kinetics Observer with the current maximum amounts of contacts and IMUs.
+  /// @details Must be called before any other configuration of the Kinetics Observer as they are lost.
+  /// @param dt The timestep of the controller
+  void resizeObserver(double dt);
   /// @brief sets all the covariances required by the Kinetics Observer
   void setObserverCovariances();
+  /// @brief Removes the entries of the observer from the datastore. They read or write the members of the observer, so
+  /// they must not be called once it is destroyed.
+  void removeFromDatastore();
   /// @brief Update the pose and velocities of the robot in the world frame. Used only to update the ones of the robot
   /// used for the visualization of the estimation made by the Kinetics Observer.
   /// @param robot The robot to update.
   void update(mc_rbdyn::Robot & robot);
 
+  /// @brief Stores the state of the Kinetics Observer (state vector, covariance, floating base kinematics and contact
+  /// references) and of its backup Tilt Observer in the checkpoint.
+  void saveState(checkpoint::Checkpoint & checkpoint);
+
+  /// @brief Restores the state saved by saveState(). Must be called at the end of reset().
+  /// @details The gyrometer biases and the unmodeled wrench are always restored. The kinematics of the floating base,
+  /// the covariance of the state and the references of the contacts are restored only when the odometry is used, as
+  /// they are otherwise given by the control robot.
+  /// @return false if the checkpoint doesn't match the configuration of the observer, which is then left untouched.
+  bool restoreState(const checkpoint::Checkpoint & checkpoint);
+
   /// @brief Initializer for the Kinetics Observer's state vector
   /// @param robot The control robot
   void initObserverStateVector(const mc_control::MCController & ctl, const mc_rbdyn::Robot & robot);
@@ -127,6 +191,16 @@ protected:
   /// @param contact Contact
   /// @param logger
   void removeContactMeasurementsLogEntries(mc_rtc::Logger & logger, const KoContactWithSensor & contact);
+  /// @brief Add all the logs of the desired contact, kept until the end of the execution.
+  /// @details Used instead of the functions above if the contact logs are pre-registered. Called only once per
+  /// contact, when the observer is added to the logger or when the contact is added to the manager. The validity flags
+  /// indicate if the logged values correspond to a set contact.
+  /// @param Controller Controller
+  /// @param contact contact
+  /// @param logger
+  void addPreRegisteredContactLogEntries(const mc_control::MCController & ctl,
+                                         mc_rtc::Logger & logger,
+                                         const KoContactWithSensor & contact);
 
   void addToLogger(const mc_control::MCController &, mc_rtc::Logger &, const std::string & category) override;
 
@@ -154,18 +228,21 @@ protected:
   /// @brief Update the currently set contacts.
   /// @param ctl Controller
   /// @param logger Logger
-  void updateContacts(const mc_control::MCController & ctl, mc_rtc::Logger & logger);
+  /// @param samplingTime Time elapsed since the previous update of the Kinetics Observer
+  void updateContacts(const mc_control::MCController & ctl, mc_rtc::Logger & logger, double samplingTime);
 
   /// @brief Computes the kinematics of the contact attached to the robot in the world frame.
   /// @details Also updates the wrench measured at the contact if required.
   /// @param contact Contact of which we want to compute the kinematics
   /// @param robot robot the contacts belong to
   /// @param fs force sensor
-  /// @return stateObservation::kine::Kinematics &
-  const stateObservation::kine::Kinematics getContactWorldKinematics(const KoContactWithSensor & contact,
-                                                                     const mc_rbdyn::Robot & robot,
-                                                                     const mc_rbdyn::ForceSensor & fs,
-                                                                     const sva::ForceVecd * measuredWrench = nullptr);
+  /// @param worldContactKine kinematics of the contact in the world, which are modified by this function.
+  /// @param measuredWrench wrench measured by the force sensor. The measurement of the contact is updated if given.
+  void getContactWorldKinematics(const KoContactWithSensor & contact,
+                                 const mc_rbdyn::Robot & robot,
+                                 const mc_rbdyn::ForceSensor & fs,
+                                 stateObservation::kine::Kinematics & worldContactKine,
+                                 const sva::ForceVecd * measuredWrench = nullptr);
 
   /// @brief Updates the measurements of the force sensor attached to a contact.
   /// @details Expresses the measured wrench in the frame of the contact. The sensor is generally not directly attached
@@ -203,6 +280,88 @@ protected:
   /// @param logger Logger
   void updateContact(const mc_control::MCController & ctl, KoContactWithSensor & contact);
 
+  /// @brief Stages of the run() function whose computation time can be measured.
+  enum RunStage : size_t
+  {
+    tiltObserverStage,
+    inputRobotKinematicsStage,
+    updateContactsStage,
+    inputAdditionalWrenchStage,
+    updateIMUsStage,
+    centroidalInputsStage,
+    ekfUpdateStage,
+    ekfWaitStage,
+    floatingBaseUpdateStage,
+    debugLogsStage,
+    totalStage,
+    nbRunStages
+  };
+
+  /// @brief Returns the histogram in which the computation time of the given stage must be recorded, or nullptr if the
+  /// measurement of the computation times is disabled.
+  /// @param stage The stage of the run() function
+  inline profiling::LatencyHistogram * stageTimings(RunStage stage) noexcept
+  {
+    return withStageTimings_ ? &runStageTimings_[stage] : nullptr;
+  }
+
+  /// @brief Updates the Kinetics Observer with the current inputs and measurements and writes the results in the back
+  /// buffer of @updateResults_, then publishes it.
+  /// @details Runs on the worker thread in the asynchronous mode. The computation time is recorded in the ekfUpdate
+  /// stage.
+  void updateEstimation();
+
+  /// @brief Predicts the kinematics of the floating base one iteration ahead.
+  /// @details Used in the asynchronous mode to compensate the latency of one iteration of the results of the Kinetics
+  /// Observer. The accelerations are assumed constant over the iteration.
+  /// @param worldFbKine The kinematics of the floating base to predict
+  /// @param dt The timestep of the controller
+  static void compensateLatency(stateObservation::kine::Kinematics & worldFbKine, double dt);
+
+  /// @brief Gives the last delayed absolute pose measurement to the Kinetics Observer as a measurement of the current
+  /// iteration.
+  /// @details Re-running the Kalman filter from the iteration of the measurement would cost as many updates as
+  /// iterations of delay. Instead, the measurement is transported to the current iteration with the displacement of the
+  /// floating base estimated in the meantime, read from the history of the estimation. The cost is then independent of
+  /// the delay, which is limited by the length of the history (the backup interval).
+  /// @param ctl Controller
+  void inputDelayedPoseMeasurement(const mc_control::MCController & ctl);
+
+  /// @brief Updates the floating base by applying to its previous pose the displacement estimated by the Tilt Observer
+  /// over the last iteration.
+  /// @details Used on the iterations where the Kinetics Observer is not updated (invincibility frame, iterations in
+  /// between two updates in the multi-rate mode). The accelerations are obtained by finite differences.
+  /// @param dt The timestep of the controller
+  /// @return The new kinematics of the floating base in the world
+  stateObservation::kine::Kinematics propagateWithTiltObserver(double dt);
+
+  /// @brief Returns true if the update of the Kinetics Observer on this iteration is predicted or measured to exceed
+  /// its time budget.
+  /// @details In the asynchronous mode, the budget is exceeded if the update triggered on the previous iteration is
+  /// still running. Otherwise, the computation time of the update is predicted from the one of the last update. As an
+  /// update cannot be interrupted, the iteration following a degraded one always updates the Kinetics Observer to
+  /// measure its computation time again.
+  bool ekfUpdateExceedsBudget() const;
+
+  /// @brief Returns the diagonal of the state covariance matrix obtained on the last update.
+  inline const stateObservation::Vector & stateCovarianceDiagonal() const noexcept
+  {
+    return updateResults_.front().stateCovarianceDiagonal;
+  }
+
+  /// @brief Returns the prediction of the measurements from the newly corrected state.
+  /// @details Used only for the logs, it is computed at most once per iteration and only if an entry reads it.
+  const stateObservation::Vector & correctedMeasurements();
+
+  /// @brief Returns the visco-elastic wrench of the contact obtained from the newly corrected state.
+  /// @details Used only for the logs, it is computed at most once per iteration and only if an entry reads it.
+  /// @param contact The contact
+  const stateObservation::Vector6 & viscoElasticWrenchAfterCorrection(const KoContactWithSensor & contact);
+
+  /// @brief Returns the average of the covariances on the position of the set contacts.
+  /// @details Used only for the logs, it is computed at most once per iteration and only if an entry reads it.
+  const stateObservation::Matrix3 & contactsPosAverageStateCov();
+
 public:
   /** Get robot mass.
    *
@@ -293,7 +452,7 @@ public:
   /** Get last measurement vector sent to observer.
    *
    */
-  inline const Eigen::VectorXd measurements() const { return observer_.getEKF().getLastMeasurement(); }
+  inline const Eigen::VectorXd measurements() const { return observer_->getEKF().getLastMeasurement(); }
 
   /** Floating-base transform estimate.
    *
@@ -307,13 +466,19 @@ public:
 
 private:
   /* Settings of the Kinetics Observers */
-  // maximum amount of contacts that we want to use with the Kinetics Observer.
-  unsigned maxContacts_;
-  // maximum amount of IMUs that we want to use with the Kinetics Observer.
-  unsigned maxIMUs_;
-
-  // instance of the Kinetics Observer
-  stateObservation::KineticsObserver observer_;
+  // default maximum amount of contacts, used until the observer is configured
+  static constexpr unsigned defaultMaxContacts = 3;
+  // default maximum amount of IMUs, used until the observer is configured
+  static constexpr unsigned defaultMaxIMUs = 1;
+  // maximum amount of contacts that we want to use with the Kinetics Observer. Can be changed with the "maxContacts"
+  // configuration entry.
+  unsigned maxContacts_ = defaultMaxContacts;
+  // maximum amount of IMUs that we want to use with the Kinetics Observer. Can be changed with the "maxIMUs"
+  // configuration entry, defaults to the amount of IMUs used for the estimation.
+  unsigned maxIMUs_ = defaultMaxIMUs;
+
+  // instance of the Kinetics Observer. Held by pointer as it is built again when its dimensions change.
+  std::unique_ptr<stateObservation::KineticsObserver> observer_;
   // instance of the Tilt Observer used as a backup
   TiltObserver tiltObserver_;
 
@@ -334,10 +499,10 @@ private:
   std::string robot_ = "";
   /* custom list of robots to display */
   std::shared_ptr<mc_rbdyn::Robots> my_robots_;
+  // kinematics shared with the other observers of the pipeline, used to update the joints of the input robot
+  pipeline::KinematicsCache * kinematicsCache_ = nullptr;
   // std::string imuSensor_ = "";
   std::vector<std::string> imuNames_; ///< list of IMUs
-  // contacts maintained during the current iteration
-  std::vector<KoContactWithSensor *> maintainedContacts_;
 
   /* Estimation parameters */
   bool debug_ = false;
@@ -345,8 +510,32 @@ private:
 
   /* Estimation results */
 
-  // state vector resulting from the Kinetics Observer esimation
-  Eigen::VectorXd res_;
+  // results of the updates of the Kinetics Observer. In the asynchronous mode, the control thread reads the results of
+  // the previous iteration while the worker thread writes the ones of the current iteration.
+  concurrency::DoubleBuffer<KoUpdateResults> updateResults_;
+  // delay between the measurements used by the last results of the Kinetics Observer and the current iteration. Equal
+  // to the update period of the Kinetics Observer in the asynchronous mode, zero otherwise.
+  double estimationLatency_ = 0.0;
+  // number of iterations between two updates of the Kinetics Observer. In-between, the floating base is propagated with
+  // the Tilt Observer, which runs on every iteration.
+  unsigned ekfUpdatePeriod_ = 1;
+  // iteration whose inputs were used by the last update of the Kinetics Observer
+  size_t lastUpdateIter_ = 0;
+  // maximum computation time (s) of an update of the Kinetics Observer, 0 if unlimited. On the iterations where it is
+  // exceeded, the floating base is propagated with the Tilt Observer instead.
+  double ekfTimeBudget_ = 0.0;
+  // number of iterations on which the update of the Kinetics Observer was skipped because of the time budget
+  uint64_t degradedIters_ = 0;
+  // set from the gui to simulate the detection of a NaN on the next iteration
+  bool nanSimulationRequested_ = false;
+  // last absolute pose measurement received through the datastore
+  KoDelayedPoseMeasurement delayedPoseMeas_;
+  // file in which the state of the observer is saved when it is destroyed, and from which it is restored on reset.
+  // Empty if the warm start is disabled.
+  std::string checkpointFile_;
+  // reference kinematics of the contacts restored from the checkpoint, used instead of the ones given by the odometry
+  // for the contacts set on the first iteration
+  std::unordered_map<std::string, stateObservation::kine::Kinematics> restoredContactRefs_;
   // pose of the floating base within the world frame (real one, not the one of the control robot)
   sva::PTransformd X_0_fb_;
   // velocity of the floating base within the world frame (real one, not the one of the control robot)
@@ -366,9 +555,20 @@ private:
   // linear damping of contacts
   stateObservation::Matrix3 angDamping_;
 
+#ifdef MC_STATE_OBSERVATION_HEADLESS
+  // the debug logs are compiled out of the headless builds.
+  static constexpr bool withDebugLogs_ = false;
+#else
   // indicates if the debug logs have to be added.
   bool withDebugLogs_ = false;
+#endif
+  // indicates if the debug logs of all the contacts are added once and kept, with a validity flag, instead of being
+  // added and removed each time a contact is set or removed.
+  bool withPreRegisteredContactLogs_ = false;
+  // For logs only. Average of the covariances on the position of the set contacts.
   stateObservation::Matrix3 contactsPosAverageStateCov_;
+  // iteration at which contactsPosAverageStateCov_ was computed
+  size_t contactsPosAverageStateCovIter_ = koInvalidIter;
 
   // indicates if we want to perform odometry, and if yes, flat or 6d odometry
   measurements::OdometryType odometryType_;
@@ -440,6 +640,8 @@ private:
   // list of the force sensors that cannot be used with contacts but we want to use their measurements as inputs to the
   // Kinetics Observer
   std::vector<std::string> forceSensorsAsInput_ = std::vector<std::string>();
+  // indices of the force sensors of forceSensorsAsInput_ in the list of force sensors of the robot
+  std::vector<size_t> forceSensorsAsInputIndices_;
 
   /* IMU variables */
   // manager for the IMUs
@@ -473,13 +675,34 @@ private:
   int invincibilityIter_;
 
   // Buffer containing the estimated pose of the floating base in the world over the whole backup interval.
-  boost::circular_buffer<stateObservation::kine::Kinematics> koBackupFbKinematics_;
+  backup::FbKinematicsHistory koBackupFbKinematics_;
+
+  /* Computation time measurements */
+  // names of the stages of run(), used for the logs and the datastore
+  static constexpr std::array<const char *, nbRunStages> runStagesNames_ = {
+      "tiltObserver", "inputRobotKinematics", "updateContacts", "inputAdditionalWrench", "updateIMUs",
+      "centroidalInputs", "ekfUpdate", "ekfWait", "floatingBaseUpdate", "debugLogs", "total"};
+  // indicates if the computation time of each stage of run() must be measured
+  bool withStageTimings_ = false;
+  // computation times of each stage of run()
+  std::array<profiling::LatencyHistogram, nbRunStages> runStageTimings_;
+  // datastore in which the entries of the observer are published, kept to remove them when the observer is destroyed
+  mc_rtc::DataStore * datastore_ = nullptr;
 
   /* Debug variables */
+  // index of the current iteration, used to compute the debug variables at most once per iteration
+  size_t runIter_ = 0;
   // For logs only. Prediction of the measurements from the newly corrected state
   stateObservation::Vector correctedMeasurements_;
+  // iteration at which correctedMeasurements_ was computed
+  size_t correctedMeasurementsIter_ = koInvalidIter;
   // For logs only. Kinematics of the centroid frame within the world frame
   stateObservation::kine::Kinematics globalCentroidKinematics_;
+
+  /* Asynchronous update */
+  // thread running the update of the Kinetics Observer in the asynchronous mode, nullptr otherwise. Declared last so it
+  // is stopped before the destruction of the variables used by its job.
+  std::unique_ptr<concurrency::AsyncWorker> updateWorker_;
 };
 
 } // namespace mc_state_observation
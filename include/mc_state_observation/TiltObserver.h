@@ -1,8 +1,9 @@
 #pragma once
 
-#include <boost/circular_buffer.hpp>
-
+#include <mc_state_observation/backup/FbKinematicsHistory.h>
+#include <mc_state_observation/checkpoint/Checkpoint.h>
 #include <mc_state_observation/odometry/LeggedOdometryManager.h>
+#include <mc_state_observation/pipeline/KinematicChains.h>
 #include <state-observation/observer/tilt-estimator-humanoid.hpp>
 
 namespace mc_state_observation
@@ -18,6 +19,9 @@ public:
   /// @details The parameter is given only if the Tilt Observer is used as a backup by the Kinetics Observer
   TiltObserver(const std::string & type, double dt, bool asBackup = false);
 
+  /// @brief Destructor. Saves the state of the estimator in the checkpoint file, if any.
+  ~TiltObserver() override;
+
   void configure(const mc_control::MCController & ctl, const mc_rtc::Configuration &) override;
 
   void reset(const mc_control::MCController & ctl) override;
@@ -72,8 +76,7 @@ public:
   /// @param koBackupFbKinematics Buffer containing the pose of the floating base in the world estimated by the Kinetics
   /// Observer over the whole backup interval.
   /// @return const stateObservation::kine::Kinematics
-  const stateObservation::kine::Kinematics backupFb(
-      boost::circular_buffer<stateObservation::kine::Kinematics> * koBackupFbKinematics);
+  const stateObservation::kine::Kinematics backupFb(backup::FbKinematicsHistory * koBackupFbKinematics);
 
   /// @brief Computes the pose transformation estimated by the Tilt Observer between the last two iterations and
   /// applies it to the given kinematics.
@@ -82,6 +85,15 @@ public:
   /// @return stateObservation::kine::Kinematics
   stateObservation::kine::Kinematics applyLastTransformation(const stateObservation::kine::Kinematics & kine);
 
+  /// @brief Stores the state of the estimator (state vector, gains and pose of the floating base) in the checkpoint.
+  /// @param prefix Prefix of the entries, allowing to store several observers in the same checkpoint.
+  void saveState(checkpoint::Checkpoint & checkpoint, const std::string & prefix) const;
+
+  /// @brief Restores the state of the estimator from the checkpoint. Must be called after reset().
+  /// @param prefix Prefix of the entries, must be the one given to saveState().
+  /// @return false if the checkpoint doesn't contain a valid state for this estimator, which is then left untouched.
+  bool restoreState(const checkpoint::Checkpoint & checkpoint, const std::string & prefix);
+
 protected:
   /*! \brief update the robot pose in the world only for visualization purpose
    *
@@ -115,6 +127,15 @@ protected:
   std::string category_;
   // container for our robots
   std::shared_ptr<mc_rbdyn::Robots> my_robots_;
+  // kinematics shared with the other observers of the pipeline, used to update the joints of the updated robot
+  pipeline::KinematicsCache * kinematicsCache_ = nullptr;
+  // if true, when the odometry is not used, only the kinematic chains going from the floating base to the IMU and to
+  // the anchor frame are updated in the updated robot, instead of the whole robot.
+  bool partialKinematics_ = false;
+  // bodies read by the anchor frame function in addition to the ones of the feet surfaces, whose chains are updated too
+  std::vector<std::string> anchorFrameBodies_;
+  // kinematic chains updated in the partial kinematics mode
+  pipeline::KinematicChains kinematicChains_;
 
   std::string robot_; // name of the robot
   bool updateRobot_ = true; // indicates whether we use our estimation to update the real robot or not
@@ -140,6 +161,9 @@ protected:
   double beta_ = 1;
   /// initial value of the parameter related to the orthogonality
   double gamma_ = 2;
+  // indicates if the gains reached their final values. Also set when the estimator is restored from a checkpoint saved
+  // after its initial convergence.
+  bool finalGainsReached_ = false;
 
   // flag indicating the variables we want in the resulting Kinematics object
   stateObservation::kine::Kinematics::Flags::Byte flagPoseVels_ =
@@ -209,12 +233,18 @@ protected:
 
   /* Odometry parameters */
   odometry::LeggedOdometryManager odometryManager_; // manager for the legged odometry
+  // datastore in which the contact events are published, kept to remove them when the observer is destroyed
+  mc_rtc::DataStore * datastore_ = nullptr;
+
+  // file in which the state of the estimator is saved when the observer is destroyed, and from which it is restored on
+  // reset. Empty if the warm start is disabled.
+  std::string checkpointFile_;
 
   /* Variables for the use as a backup */
   // indicates if the estimator is used as a backup or not
   bool asBackup_ = false;
   // Buffer containing the estimated pose of the floating base in the world over the whole backup interval.
-  boost::circular_buffer<stateObservation::kine::Kinematics> backupFbKinematics_;
+  backup::FbKinematicsRing backupFbKinematics_;
 
   /* Debug variables */
   // "measured" local linear velocity of the IMU
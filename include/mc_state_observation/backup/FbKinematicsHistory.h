@@ -0,0 +1,63 @@
+#pragma once
+
+#include <mc_state_observation/backup/FbKinematicsRing.h>
+
+namespace mc_state_observation::backup
+{
+
+/// @brief History of the kinematics of the floating base estimated by an observer over the backup interval, which can
+/// be replaced by the history of its backup observer.
+/// @details On a backup, each entry of the history must be replaced by the corresponding estimate of the backup
+/// observer, expressed from the oldest entry of the history (re-anchoring). As the transformation between both is the
+/// same for all the entries, the history only keeps it along with a reference to the history of the backup observer,
+/// and applies it when an entry is read. The re-anchoring is then done in constant time, whatever the length of the
+/// backup interval.
+class FbKinematicsHistory
+{
+public:
+  using Kinematics = stateObservation::kine::Kinematics;
+  /// @brief History of the backup observer, which receives its entries on the same iterations as this one.
+  using Reference = FbKinematicsRing;
+
+  /// @brief Sets the maximum number of entries of the history. Also cancels any previous re-anchoring.
+  void set_capacity(size_t capacity);
+
+  /// @brief Number of entries of the history.
+  inline size_t size() const noexcept { return entries_.size(); }
+
+  /// @brief Adds a new entry to the history, which replaces the oldest one if the history is full.
+  void push_back(const Kinematics & kine);
+
+  /// @brief Returns the i-th oldest entry of the history.
+  Kinematics at(size_t i) const;
+
+  /// @brief Returns the oldest entry of the history.
+  inline Kinematics front() const { return at(0); }
+
+  /// @brief Returns the newest entry of the history.
+  inline Kinematics back() const { return at(size() - 1); }
+
+  /// @brief Replaces the newest entry of the history.
+  void setBack(const Kinematics & kine);
+
+  /// @brief Replaces all the entries of the history by the ones of the reference, on which the given transformation is
+  /// applied.
+  /// @details The entries are not computed here but when they are read, the reference must then stay alive and keep
+  /// receiving its entries on the same iterations as this history. The entries added afterwards are not affected.
+  /// @param anchor The transformation applied to the entries of the reference.
+  /// @param reference The history of the backup observer.
+  void reanchor(const Kinematics & anchor, const Reference & reference);
+
+private:
+  FbKinematicsRing entries_;
+  // history of the backup observer giving the entries that were re-anchored
+  const Reference * reference_ = nullptr;
+  // transformation applied to the entries of the reference
+  Kinematics anchor_;
+  // number of entries added since the creation of the history
+  uint64_t nbPushed_ = 0;
+  // the entries added before this count are given by the reference
+  uint64_t reanchoredUntil_ = 0;
+};
+
+} // namespace mc_state_observation::backup
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <state-observation/tools/rigid-body-kinematics.hpp>
+
+namespace mc_state_observation::backup
+{
+
+/// @brief Compact ring buffer of kinematics of the floating base, used for the histories of the backup.
+/// @details Only the pose (quaternion and position) and optionally the velocities are stored, each in its own
+/// contiguous array (structure of arrays). This takes several times less memory than a buffer of full
+/// stateObservation::kine::Kinematics, and the entries are unpacked into a stateObservation::kine::Kinematics only
+/// when they are read. The memory is allocated once by set_capacity().
+class FbKinematicsRing
+{
+public:
+  using Kinematics = stateObservation::kine::Kinematics;
+
+  /// @brief Constructor.
+  /// @param withVelocities If true, the linear and angular velocities of the entries are stored too.
+  explicit FbKinematicsRing(bool withVelocities = false) : withVelocities_(withVelocities) {}
+
+  /// @brief Sets the maximum number of entries and removes all the current ones.
+  void set_capacity(size_t capacity);
+
+  /// @brief Maximum number of entries.
+  inline size_t capacity() const noexcept { return static_cast<size_t>(positions_.cols()); }
+
+  /// @brief Number of entries.
+  inline size_t size() const noexcept { return size_; }
+
+  /// @brief Returns true if the buffer contains no entry.
+  inline bool empty() const noexcept { return size_ == 0; }
+
+  /// @brief Adds a new entry, which replaces the oldest one if the buffer is full. Only the pose (and the velocities
+  /// if stored) of the kinematics is kept.
+  void push_back(const Kinematics & kine);
+
+  /// @brief Returns the i-th oldest entry.
+  Kinematics at(size_t i) const;
+
+  /// @brief Returns the oldest entry.
+  inline Kinematics front() const { return at(0); }
+
+  /// @brief Returns the newest entry.
+  inline Kinematics back() const { return at(size_ - 1); }
+
+  /// @brief Replaces the newest entry. Throws if the buffer is empty.
+  void setBack(const Kinematics & kine);
+
+private:
+  /// @brief Index in the arrays of the i-th oldest entry.
+  inline Eigen::Index index(size_t i) const noexcept { return static_cast<Eigen::Index>((first_ + i) % capacity()); }
+
+  /// @brief Stores the kinematics at the given index of the arrays.
+  void store(Eigen::Index index, const Kinematics & kine);
+
+private:
+  bool withVelocities_;
+  // quaternions (x, y, z, w) of the orientations
+  Eigen::Matrix4Xd orientations_;
+  Eigen::Matrix3Xd positions_;
+  Eigen::Matrix3Xd linVels_;
+  Eigen::Matrix3Xd angVels_;
+  // index in the arrays of the oldest entry
+  size_t first_ = 0;
+  size_t size_ = 0;
+};
+
+} // namespace mc_state_observation::backup
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <Eigen/Core>
+
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace mc_state_observation::checkpoint
+{
+
+/// @brief State of the observers saved to a compact binary file, used to restart them without going through their
+/// convergence again (warm start).
+/// @details The checkpoint is a set of named matrices of doubles. Each observer stores its entries under its own prefix
+/// and checks their dimensions when restoring them, so that a checkpoint written with a different configuration is
+/// ignored instead of corrupting the estimation. The file contains a header followed by, for each entry, its name, its
+/// dimensions and its values in column-major order.
+class Checkpoint
+{
+public:
+  /// @brief Sets the value of an entry, replacing the previous one if any.
+  void set(const std::string & key, const Eigen::Ref<const Eigen::MatrixXd> & value);
+
+  /// @brief Sets the value of a scalar entry.
+  inline void set(const std::string & key, double value) { set(key, Eigen::Matrix<double, 1, 1>::Constant(value)); }
+
+  /// @brief Returns true if the checkpoint contains the entry.
+  inline bool has(const std::string & key) const { return entries_.count(key) > 0; }
+
+  /// @brief Returns the names of the entries starting with the given prefix, with the prefix removed.
+  std::vector<std::string> keys(const std::string & prefix) const;
+
+  /// @brief Gets the value of an entry.
+  /// @return false if the entry is missing or if its dimensions differ from the ones of the given fixed-size value.
+  template<typename Derived>
+  bool get(const std::string & key, Eigen::PlainObjectBase<Derived> & value) const
+  {
+    auto it = entries_.find(key);
+    if(it == entries_.end()) { return false; }
+    const Eigen::MatrixXd & entry = it->second;
+    if((Derived::RowsAtCompileTime != Eigen::Dynamic && entry.rows() != Derived::RowsAtCompileTime)
+       || (Derived::ColsAtCompileTime != Eigen::Dynamic && entry.cols() != Derived::ColsAtCompileTime))
+    {
+      return false;
+    }
+    value = entry;
+    return true;
+  }
+
+  /// @brief Gets the value of a scalar entry.
+  /// @return false if the entry is missing or is not a scalar.
+  bool get(const std::string & key, double & value) const;
+
+  /// @brief Writes the checkpoint to the given file. Throws if the file cannot be written.
+  void save(const std::string & path) const;
+
+  /// @brief Reads the checkpoint from the given file. Throws if the file cannot be read or is not a checkpoint.
+  static Checkpoint load(const std::string & path);
+
+  /// @brief Writes the checkpoint to the given file, logging the failure instead of throwing. Used when the observers
+  /// are destroyed.
+  /// @param observerName Name of the observer saving its state, for the logs.
+  /// @return false if the file could not be written.
+  bool trySave(const std::string & path, const std::string & observerName) const noexcept;
+
+  /// @brief Reads the checkpoint from the given file if it exists, logging the reason of the cold start otherwise.
+  /// @param observerName Name of the observer restoring its state, for the logs.
+  /// @return std::nullopt if the file doesn't exist or cannot be read.
+  static std::optional<Checkpoint> tryLoad(const std::string & path, const std::string & observerName);
+
+private:
+  std::map<std::string, Eigen::MatrixXd> entries_;
+};
+
+} // namespace mc_state_observation::checkpoint
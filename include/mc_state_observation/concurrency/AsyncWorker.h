@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace mc_state_observation::concurrency
+{
+
+/// @brief Thread executing a job each time it is triggered, used to move a computation off the real-time thread.
+/// @details The job is given on construction and is executed once per call to trigger(). The real-time thread triggers
+/// the job and later waits for its completion, normally on the next iteration, when the job is already finished.
+class AsyncWorker
+{
+public:
+  /// @brief Starts the thread, which sleeps until the job is triggered.
+  /// @param job The job to execute on each trigger.
+  explicit AsyncWorker(std::function<void()> job);
+  /// @brief Waits for the completion of the current job and stops the thread.
+  ~AsyncWorker();
+  AsyncWorker(const AsyncWorker &) = delete;
+  AsyncWorker & operator=(const AsyncWorker &) = delete;
+
+  /// @brief Requests an execution of the job. Must not be called before the completion of the previous one.
+  void trigger();
+
+  /// @brief Waits for the completion of the last triggered job. Returns immediately if it is already finished.
+  void wait() const noexcept;
+
+  /// @brief Returns true if the last triggered job is not finished yet.
+  inline bool busy() const noexcept { return pending_.load(std::memory_order_acquire); }
+
+private:
+  /// @brief Loop of the worker thread.
+  void loop();
+
+private:
+  std::function<void()> job_;
+  // true from the trigger of the job until its completion
+  std::atomic<bool> pending_{false};
+  bool stop_ = false;
+  // used only to put the worker thread to sleep between two jobs, never held while a job runs
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::thread thread_;
+};
+
+} // namespace mc_state_observation::concurrency
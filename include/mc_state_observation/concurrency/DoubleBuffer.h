@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+
+namespace mc_state_observation::concurrency
+{
+
+/// @brief Lock-free double buffer with a single writer and a single reader.
+/// @details The writer fills the back buffer and publishes it. The reader latches the last published buffer with
+/// acquire() and then reads it with front() as long as needed, even if the writer publishes a new buffer in the
+/// meantime. The writer must not write two buffers without an acquire() of the reader in between, which is the case
+/// when the reader triggers each write (see AsyncWorker).
+template<typename T>
+class DoubleBuffer
+{
+public:
+  DoubleBuffer() = default;
+  DoubleBuffer(const DoubleBuffer &) = delete;
+  DoubleBuffer & operator=(const DoubleBuffer &) = delete;
+
+  /// @brief Returns the buffer to fill. Must be called only by the writer.
+  inline T & back() noexcept { return buffers_[1 - published_.load(std::memory_order_relaxed)]; }
+
+  /// @brief Makes the back buffer available to the reader. Must be called only by the writer.
+  inline void publish() noexcept
+  {
+    published_.store(1 - published_.load(std::memory_order_relaxed), std::memory_order_release);
+  }
+
+  /// @brief Latches the last published buffer, returned by front() until the next call. Must be called only by the
+  /// reader.
+  inline void acquire() noexcept { latched_ = published_.load(std::memory_order_acquire); }
+
+  /// @brief Returns the buffer latched by the last call to acquire().
+  inline const T & front() const noexcept { return buffers_[latched_]; }
+
+  /// @brief Gives access to both buffers, to initialize them. Must not be called while the writer is running.
+  inline std::array<T, 2> & buffers() noexcept { return buffers_; }
+
+private:
+  std::array<T, 2> buffers_;
+  // index of the last published buffer
+  std::atomic<int> published_{0};
+  // index of the buffer read by the reader
+  int latched_ = 0;
+};
+
+} // namespace mc_state_observation::concurrency
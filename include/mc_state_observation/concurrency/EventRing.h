@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace mc_state_observation::concurrency
+{
+
+/// @brief Lock-free ring buffer of events with a single writer and any number of readers.
+/// @details The writer never waits: when the buffer is full, the oldest events are overwritten. Each reader keeps its
+/// own cursor (the sequence number of the next event to read) and polls the events it didn't read yet. A reader that
+/// is overtaken by the writer skips the overwritten events, and is told how many it missed. Each slot is protected by
+/// a sequence number (seqlock), so a reader never returns an event that was being overwritten while it was copied.
+/// @tparam T Event, must be trivially copyable.
+/// @tparam Capacity Maximum number of events kept in the buffer.
+template<typename T, size_t Capacity>
+class EventRing
+{
+  static_assert(std::is_trivially_copyable_v<T>, "The events of the EventRing must be trivially copyable");
+  static_assert(Capacity > 0, "The capacity of the EventRing must be positive");
+
+public:
+  EventRing() = default;
+  EventRing(const EventRing &) = delete;
+  EventRing & operator=(const EventRing &) = delete;
+
+  /// @brief Adds an event, overwriting the oldest one if the buffer is full. Must be called only by the writer.
+  inline void push(const T & event) noexcept
+  {
+    const uint64_t seq = written_.load(std::memory_order_relaxed);
+    Slot & slot = slots_[seq % Capacity];
+    // odd sequence: the slot is being written
+    slot.seq.store(2 * seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.event = event;
+    slot.seq.store(2 * seq + 2, std::memory_order_release);
+    written_.store(seq + 1, std::memory_order_release);
+  }
+
+  /// @brief Reads the next event after the cursor of the reader.
+  /// @param cursor Sequence number of the next event to read, owned by the reader. Initialized with 0 to read all the
+  /// events still in the buffer, or with written() to read only the upcoming ones. Advanced past the read event.
+  /// @param event The read event.
+  /// @param missed If given, incremented by the number of events overwritten before the reader could read them.
+  /// @return false if there is no new event.
+  inline bool poll(uint64_t & cursor, T & event, uint64_t * missed = nullptr) const noexcept
+  {
+    while(true)
+    {
+      const uint64_t written = written_.load(std::memory_order_acquire);
+      if(cursor >= written) { return false; }
+      if(written - cursor > Capacity)
+      {
+        if(missed) { *missed += written - Capacity - cursor; }
+        cursor = written - Capacity;
+      }
+
+      const Slot & slot = slots_[cursor % Capacity];
+      const uint64_t seq = slot.seq.load(std::memory_order_acquire);
+      if(seq == 2 * cursor + 2)
+      {
+        event = slot.event;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // the event was not overwritten while it was copied
+        if(slot.seq.load(std::memory_order_relaxed) == seq)
+        {
+          ++cursor;
+          return true;
+        }
+      }
+      // the slot was overwritten by the writer, we skip to the oldest event still available
+      if(missed) { *missed += 1; }
+      ++cursor;
+    }
+  }
+
+  /// @brief Total number of events written so far, also the sequence number of the next event.
+  inline uint64_t written() const noexcept { return written_.load(std::memory_order_acquire); }
+
+  /// @brief Maximum number of events kept in the buffer.
+  static constexpr size_t capacity() noexcept { return Capacity; }
+
+private:
+  struct Slot
+  {
+    // 2 * (sequence number of the event) + 2 once written, odd while being written
+    std::atomic<uint64_t> seq{0};
+    T event;
+  };
+
+  std::array<Slot, Capacity> slots_;
+  // number of events written so far
+  std::atomic<uint64_t> written_{0};
+};
+
+} // namespace mc_state_observation::concurrency
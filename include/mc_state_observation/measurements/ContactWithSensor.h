@@ -33,11 +33,20 @@ public:
 
   inline void forceNorm(double forceNorm) { forceNorm_ = forceNorm; }
 
+  /// @brief Sets the index of the force sensor in the list of force sensors of the robot. Set once by the contacts
+  /// manager when the contact is created.
+  inline void forceSensorIndex(size_t forceSensorIndex) { forceSensorIndex_ = forceSensorIndex; }
+
   inline const std::string & forceSensor() const noexcept { return forceSensor_; }
+  /// @brief Index of the force sensor in the list of force sensors of the robot (mc_rbdyn::Robot::forceSensors()).
+  /// @details Valid for all the robots sharing the module of the robot given to the contacts manager, allowing to
+  /// access the sensor without looking up its name.
+  inline size_t forceSensorIndex() const noexcept { return forceSensorIndex_; }
   inline double forceNorm() const noexcept { return forceNorm_; }
 
 protected:
   std::string forceSensor_;
+  size_t forceSensorIndex_ = 0;
   double forceNorm_ = 0.0;
 };
 } // namespace mc_state_observation::measurements
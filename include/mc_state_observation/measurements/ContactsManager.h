@@ -1,5 +1,6 @@
 #pragma once
 #include <mc_control/MCController.h>
+#include <mc_state_observation/concurrency/EventRing.h>
 #include <mc_state_observation/measurements/ContactWithSensor.h>
 #include <mc_state_observation/measurements/ContactsManagerConfiguration.h>
 
@@ -12,15 +13,49 @@ struct SchmittTrigger
   double upperThreshold;
 };
 
-/// @brief Structure that implements all the necessary functions to manage the map of contacts. Handles their detection
+/// @brief Transition of a contact of the ContactsManager, published in its event stream.
+struct ContactEvent
+{
+  enum class Type : uint8_t
+  {
+    // the contact was added to the manager
+    Added,
+    // the contact got set
+    New,
+    // the contact was set and is not anymore
+    Removed
+  };
+
+  // index of the iteration of the contacts manager (call to updateContacts) at which the transition occured
+  uint64_t tick;
+  // id of the contact, see ContactsManager::contact(unsigned)
+  unsigned contactId;
+  Type type;
+  // norm of the measured force at the transition
+  double forceNorm;
+  // thresholds of the Schmitt trigger at the transition
+  SchmittTrigger schmittTrigger;
+};
+
+// maximum number of contact events kept until they are read
+inline constexpr size_t contactEventsCapacity = 256;
+/// @brief Stream of the transitions of the contacts of a ContactsManager. Published in the datastore by the observers
+/// as <observer name>::ContactEvents.
+using ContactEvents = concurrency::EventRing<ContactEvent, contactEventsCapacity>;
+
+/// @brief Structure that implements all the necessary functions to manage the list of contacts. Handles their detection
 /// and updates the list of the detected contacts, newly removed contacts, etc., to apply the appropriate functions on
 /// them.
-/// @details The template allows to define other kinds of contacts and thus add custom parameters to them.
+/// @details The template allows to define other kinds of contacts and thus add custom parameters to them. The contacts
+/// are stored contiguously and indexed by their id. Their names are looked up only when configuring the manager, and
+/// the index of their force sensor is resolved once when they are created.
 /// @tparam ContactT Contact, associated to a sensor.
 template<typename ContactT>
 struct ContactsManager
 {
 public:
+  using ContactEvents = measurements::ContactEvents;
+
   // allowed contact detection methods
   enum ContactsDetection
   {
@@ -43,26 +78,31 @@ private:
       {{"Solver", Solver}, {"Surfaces", Surfaces}, {"Sensors", Sensors}, {"Undefined", Undefined}};
 
 protected:
-  /// @brief Inserts a contact to the map of contacts.
+  /// @brief Inserts a contact to the list of contacts.
   /// @details Version for contacts that are associated to both a force sensor and a contact surface. The contact will
   /// be named with the name of the force sensor.
+  /// @param robot The robot owning the force sensor.
   /// @param forceSensorName The name of the force sensor.
   /// @param surface The name of the surface that will be used also to name the contact.
   /// @param onAddedContact function to call when a contact is added to the manager
   /// @return ContactT &
   template<typename OnAddedContact = std::nullptr_t>
-  inline ContactT & addContactToManager(const std::string & forceSensorName,
+  inline ContactT & addContactToManager(const mc_rbdyn::Robot & robot,
+                                        const std::string & forceSensorName,
                                         const std::string & surface,
                                         OnAddedContact onAddedContact = nullptr);
-  /// @brief Insert a contact to the map of contacts.
+  /// @brief Insert a contact to the list of contacts.
   /// @details Version for contacts that are associated to a force sensor but to no surface.
+  /// @param robot The robot owning the force sensor.
   /// @param name The name of the contact (= name of the sensor)
   /// @param onAddedContact function to call when a contact is added to the manager
   /// @return ContactT &
   template<typename OnAddedContact = std::nullptr_t>
-  inline ContactT & addContactToManager(const std::string & forceSensorName, OnAddedContact onAddedContact = nullptr)
+  inline ContactT & addContactToManager(const mc_rbdyn::Robot & robot,
+                                        const std::string & forceSensorName,
+                                        OnAddedContact onAddedContact = nullptr)
   {
-    return addContactToManager(forceSensorName, "", onAddedContact);
+    return addContactToManager(robot, forceSensorName, "", onAddedContact);
   }
 
   /// @brief Detects the currently set contacts based on the surfaces given by the user. Applies custom functions for
@@ -113,6 +153,52 @@ protected:
                               OnMaintainedContact & onMaintainedContact,
                               OnAddedContact & onAddedContact = nullptr);
 
+  /// @brief Measures the norm of the force of all the contacts, filters them and thresholds them with the Schmitt
+  /// trigger.
+  /// @details The force norms, their filtered values and the result of the trigger are stored as arrays indexed by the
+  /// id of the contacts, so the filter and the trigger are applied to all the contacts at once. The filtered norm is
+  /// given to the contacts, and the result of the trigger is stored in contactsTriggered_, from which
+  /// applyContactTrigger() then sets the contacts.
+  /// @param measRobot The robot whose contacts are managed
+  void thresholdContactsForces(const mc_rbdyn::Robot & measRobot);
+
+  /// @brief Applies the result of the Schmitt trigger to the contact, and the matching custom function.
+  /// @param show_new_contacts Set to true if the contact just got set
+  template<typename OnNewContact, typename OnMaintainedContact>
+  inline void applyContactTrigger(ContactT & contact,
+                                  OnNewContact & onNewContact,
+                                  OnMaintainedContact & onMaintainedContact,
+                                  bool & show_new_contacts)
+  {
+    if(!contactsTriggered_(contact.id())) { return; }
+    contactsDetected_ = true;
+    contact.isSet(true);
+    if(contact.wasAlreadySet()) { onMaintainedContact(contact); }
+    else
+    {
+      show_new_contacts = true;
+      onNewContact(contact);
+    }
+  }
+
+  /// @brief Returns true if the contacts of the solver differ from the ones used to build the mapping
+  /// solverContactsIds_.
+  /// @details The solver contacts are compared through their robots and the addresses of their surfaces, which are
+  /// owned by the contacts and kept alive by the mapping, so a new contact cannot be mistaken for a cached one.
+  /// @param solverContacts The current contacts of the solver
+  bool solverContactsChanged(const std::vector<mc_rbdyn::Contact> & solverContacts) const noexcept;
+
+  /// @brief Rebuilds the mapping between the contacts of the solver and the contacts of the manager.
+  /// @details Called only when the contacts of the solver changed. Adds to the manager the contacts that were never
+  /// detected so far.
+  /// @param ctl Controller
+  /// @param measRobot The robot whose contacts are managed
+  /// @param onAddedContact Function to call when a contact is added to the manager (detected for the first time)
+  template<typename OnAddedContact>
+  void mapSolverContacts(const mc_control::MCController & ctl,
+                         const mc_rbdyn::Robot & measRobot,
+                         OnAddedContact & onAddedContact);
+
 public:
   // initialization of the contacts manager
   /// @param ctl Controller
@@ -137,6 +223,8 @@ public:
   /// @param onRemovedContact Function to call on a removed contact
   /// @param onAddedContact function to call when a contact is added to the
   /// manager
+  /// @param elapsedTime Time elapsed since the previous update of the contacts, used by the filter of the measured
+  /// forces. The time step of the controller if zero.
   /// @return void
   template<typename OnNewContact,
            typename OnMaintainedContact,
@@ -147,22 +235,46 @@ public:
                       OnNewContact onNewContact,
                       OnMaintainedContact onMaintainedContact,
                       OnRemovedContact onRemovedContact,
-                      OnAddedContact onAddedContact = nullptr);
+                      OnAddedContact onAddedContact = nullptr,
+                      double elapsedTime = 0.0);
 
   /// @brief Accessor for the a contact associated to a sensor contained in
-  /// the map
+  /// the list. Looks up the name, prefer contact(unsigned) in the real-time loop.
   ///
   /// @param name The name of the contact to access
   /// @return contactsWithSensorT&
-  inline ContactT & contact(const std::string & name) { return listContacts_.at(name); }
+  inline ContactT & contact(const std::string & name) { return listContacts_[contactsIndices_.at(name)]; }
 
-  /// @brief Get the map of all the contacts
+  /// @brief Accessor for the contact with the given id.
+  inline ContactT & contact(unsigned id) { return listContacts_[id]; }
+
+  /// @brief Get the list of all the contacts, indexed by their id
   ///
-  /// @return std::unordered_map<std::string, contactsWithSensorT>&
-  inline std::unordered_map<std::string, ContactT> & contacts() { return listContacts_; }
+  /// @return std::vector<contactsWithSensorT>&
+  inline std::vector<ContactT> & contacts() { return listContacts_; }
+
+  /// @brief Returns true if a contact is associated to the force sensor with the given index in the list of force
+  /// sensors of the robot.
+  inline bool forceSensorHasContact(size_t forceSensorIndex) const noexcept
+  {
+    return forceSensorIndex < forceSensorsContacts_.size() && forceSensorsContacts_[forceSensorIndex];
+  }
 
   inline ContactsDetection getContactsDetection() const noexcept { return contactsDetectionMethod_; }
 
+  /// @brief Stream of the transitions of the contacts, polled by the consumers with their own cursor.
+  /// @details Written by updateContacts() on the thread of the observer, can be read from any thread. Example:
+  /// \code
+  /// uint64_t cursor = manager.contactEvents().written();
+  /// ...
+  /// measurements::ContactEvent event;
+  /// while(manager.contactEvents().poll(cursor, event)) { ... }
+  /// \endcode
+  inline const ContactEvents & contactEvents() const noexcept { return contactEvents_; }
+
+  /// @brief Number of calls to updateContacts() so far, used to timestamp the contact events.
+  inline uint64_t tick() const noexcept { return tick_; }
+
   /** Returns true if any contact is detected */
   inline bool contactsDetected() const noexcept { return contactsDetected_; }
 
@@ -180,8 +292,8 @@ public:
 
   ContactT * findContact(const std::string & name)
   {
-    auto it = listContacts_.find(name);
-    if(it != listContacts_.end()) { return &(it->second); }
+    auto it = contactsIndices_.find(name);
+    if(it != contactsIndices_.end()) { return &listContacts_[it->second]; }
     return nullptr;
   }
 
@@ -229,12 +341,31 @@ private:
                            const ContactsManagerSolverConfiguration & conf,
                            OnAddedContact onAddedContact = nullptr);
 
+  /// @brief Reserves the storage of the contacts for the given amount of contacts.
+  /// @details The contacts are referenced by the observers (logs, gui), so they must not be moved once created. The
+  /// storage is allocated for all the contacts that can be created, the force sensors of the robot giving an upper
+  /// bound as the contacts are named after them.
+  /// @param robot The robot whose contacts are managed
+  void reserveContacts(const mc_rbdyn::Robot & robot);
+
+  /// @brief Prints the list of the currently set contacts.
+  /// @details Called only when the set of contacts changed, so the list is not built on every iteration.
+  void logSetContacts() const;
+
+  /// @brief Publishes a transition of the contact in the event stream.
+  inline void publishContactEvent(const ContactT & contact, ContactEvent::Type type) noexcept
+  {
+    contactEvents_.push({tick_, contact.id(), type, contact.forceNorm(), schmittTrigger_});
+  }
+
 protected:
-  // map of contacts used by the manager.
-  // unordered map containing all the contacts
-  std::unordered_map<std::string, ContactT> listContacts_;
-  // Index generator, incremented everytime a new contact is created
-  unsigned idx_ = 0;
+  // list of the contacts used by the manager, indexed by their id. Its capacity is reserved on initialization so the
+  // contacts are never moved.
+  std::vector<ContactT> listContacts_;
+  // index of each contact in the list, given its name. Used only when adding contacts and by the name accessors.
+  std::unordered_map<std::string, unsigned> contactsIndices_;
+  // indicates for each force sensor of the robot if a contact is associated to it
+  std::vector<bool> forceSensorsContacts_;
 
   // method used to detect the contacts
   ContactsDetection contactsDetectionMethod_ = Undefined;
@@ -246,6 +377,20 @@ protected:
   // set to "Surfaces"
   std::vector<std::string> surfacesForContactDetection_;
 
+  // contact of the solver, as it was when the mapping to the contacts of the manager was built
+  struct SolverContact
+  {
+    unsigned r1Index;
+    unsigned r2Index;
+    std::shared_ptr<mc_rbdyn::Surface> r1Surface;
+    std::shared_ptr<mc_rbdyn::Surface> r2Surface;
+  };
+  // contacts of the solver used to build the mapping solverContactsIds_, if @contactsDetection_ is set to "Solver"
+  std::vector<SolverContact> solverContacts_;
+  // ids of the contacts of the manager corresponding to the contacts of the solver between the robot and a fixed robot
+  // (environment). Rebuilt only when the contacts of the solver change.
+  std::vector<unsigned> solverContactsIds_;
+
   // name of the observer using this contacts manager.
   std::string observerName_;
 
@@ -253,6 +398,28 @@ protected:
 
   /** True if any contact is detected, false otherwise */
   bool contactsDetected_ = false;
+
+  /* Force thresholding, indexed by the id of the contacts */
+  // time constant of the low-pass filter of the force norms (0 if the filter is disabled)
+  double forcesFilterTimeConstant_ = 0.0;
+  // gain of the low-pass filter of the force norms over the time elapsed since the previous update (1 if the filter is
+  // disabled)
+  double forcesFilterGain_ = 1.0;
+  // number of contacts whose filtered force is initialized
+  Eigen::Index nbFilteredContacts_ = 0;
+  // measured force norms
+  Eigen::ArrayXd forceNorms_;
+  // filtered force norms
+  Eigen::ArrayXd filteredForceNorms_;
+  // indicates if the contacts were set at the previous iteration
+  Eigen::Array<bool, Eigen::Dynamic, 1> contactsWereSet_;
+  // indicates if the force of the contacts passed the Schmitt trigger
+  Eigen::Array<bool, Eigen::Dynamic, 1> contactsTriggered_;
+
+  // transitions of the contacts
+  ContactEvents contactEvents_;
+  // number of calls to updateContacts
+  uint64_t tick_ = 0;
 };
 } // namespace mc_state_observation::measurements
 
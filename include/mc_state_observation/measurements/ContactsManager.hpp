@@ -16,12 +16,16 @@ void ContactsManager<ContactT>::init(const mc_control::MCController & ctl,
                                      Configuration conf,
                                      OnAddedContact onAddedContact)
 {
+  reserveContacts(ctl.robot(robotName));
+
   std::visit(
       [this, &ctl, &robotName, onAddedContact](const auto & c)
       {
         observerName_ = c.observerName_;
         verbose_ = c.verbose_;
 
+        forcesFilterTimeConstant_ = c.forcesFilterTimeConstant_;
+
         if(c.schmittLowerPropThreshold_ && c.schmittUpperPropThreshold_)
         {
           const auto & robot = ctl.robot(robotName);
@@ -68,11 +72,11 @@ void ContactsManager<ContactT>::init_manager(const mc_control::MCController & ct
     // we get the name of the force sensor associated to the surface
     const std::string & fsName = robot.frame(surface).forceSensor().name();
     // if the surface is associated to a force sensor (for example LeftFootCenter or RightFootCenter)
-    if(robot.surfaceHasForceSensor(surface)) { addContactToManager(fsName, surface, onAddedContact); }
+    if(robot.surfaceHasForceSensor(surface)) { addContactToManager(robot, fsName, surface, onAddedContact); }
     else // if the surface is not associated to a force sensor, we will fetch the force sensor indirectly attached to
          // the surface
     {
-      addContactToManager(fsName, surface, onAddedContact);
+      addContactToManager(robot, fsName, surface, onAddedContact);
     }
   }
 }
@@ -96,7 +100,7 @@ void ContactsManager<ContactT>::init_manager(const mc_control::MCController & ct
     }
     const std::string & fsName = forceSensor.name();
 
-    addContactToManager(fsName, onAddedContact);
+    addContactToManager(robot, fsName, onAddedContact);
   }
 }
 
@@ -117,14 +121,17 @@ void ContactsManager<ContactT>::updateContacts(const mc_control::MCController &
                                                OnNewContact onNewContact,
                                                OnMaintainedContact onMaintainedContact,
                                                OnRemovedContact onRemovedContact,
-                                               OnAddedContact onAddedContact)
+                                               OnAddedContact onAddedContact,
+                                               double elapsedTime)
 {
+  ++tick_;
+  // the contacts may not be updated on every iteration, the gain of the filter depends on the time elapsed since the
+  // previous update
+  const double dt = elapsedTime > 0.0 ? elapsedTime : ctl.timeStep;
+  forcesFilterGain_ = forcesFilterTimeConstant_ > 0.0 ? dt / (forcesFilterTimeConstant_ + dt) : 1.0;
   // Reset contact detection
   contactsDetected_ = false;
-  bool show_broken_contacts = false;
-  // Filled-up when verbose
-  std::string broken_contact_set;
-  for(auto & [_, c] : listContacts_)
+  for(auto & c : listContacts_)
   {
     c.wasAlreadySet(c.isSet());
     c.isSet(false);
@@ -145,104 +152,177 @@ void ContactsManager<ContactT>::updateContacts(const mc_control::MCController &
       mc_rtc::log::error_and_throw("No contacts detection method was defined.");
       break;
   }
-  // Handle removed contacts
-  for(auto & [_, c] : listContacts_)
+  // Handle removed contacts and publish the transitions. The removed contacts are not printed, the consumers can read
+  // them in the event stream.
+  for(auto & c : listContacts_)
   {
     if(c.wasAlreadySet() && !c.isSet())
     {
+      publishContactEvent(c, ContactEvent::Type::Removed);
       onRemovedContact(c);
       c.resetContact();
-      show_broken_contacts = true;
-
-      if(verbose_)
-      {
-        if(!broken_contact_set.empty()) { broken_contact_set += ", "; }
-        broken_contact_set += c.name();
-      }
     }
+    else if(c.isSet() && !c.wasAlreadySet()) { publishContactEvent(c, ContactEvent::Type::New); }
   }
-  if(verbose_ && show_broken_contacts)
+}
+
+template<typename ContactT>
+void ContactsManager<ContactT>::reserveContacts(const mc_rbdyn::Robot & robot)
+{
+  const size_t nbForceSensors = robot.forceSensors().size();
+  listContacts_.reserve(nbForceSensors);
+  forceSensorsContacts_.resize(nbForceSensors, false);
+
+  const auto capacity = static_cast<Eigen::Index>(nbForceSensors);
+  forceNorms_.setZero(capacity);
+  filteredForceNorms_.setZero(capacity);
+  contactsWereSet_.setConstant(capacity, false);
+  contactsTriggered_.setConstant(capacity, false);
+  nbFilteredContacts_ = 0;
+}
+
+template<typename ContactT>
+void ContactsManager<ContactT>::thresholdContactsForces(const mc_rbdyn::Robot & measRobot)
+{
+  const auto nbContacts = static_cast<Eigen::Index>(listContacts_.size());
+
+  for(const auto & contact : listContacts_)
   {
-    mc_rtc::log::info("[{}] Contacts removed: {}", observerName_, broken_contact_set);
+    const mc_rbdyn::ForceSensor & forceSensor = measRobot.forceSensors()[contact.forceSensorIndex()];
+    forceNorms_(contact.id()) = forceSensor.wrenchWithoutGravity(measRobot).force().norm();
+    contactsWereSet_(contact.id()) = contact.wasAlreadySet();
   }
+
+  // the filtered force of the contacts added since the last iteration starts from their measurement
+  auto filtered = filteredForceNorms_.head(nbContacts);
+  const auto measured = forceNorms_.head(nbContacts);
+  filtered.segment(nbFilteredContacts_, nbContacts - nbFilteredContacts_) =
+      measured.segment(nbFilteredContacts_, nbContacts - nbFilteredContacts_);
+  nbFilteredContacts_ = nbContacts;
+
+  if(forcesFilterGain_ < 1.0) { filtered += forcesFilterGain_ * (measured - filtered); }
+  else { filtered = measured; }
+
+  // a set contact is maintained while its force is above the lower threshold, a new contact must exceed the upper one
+  const auto wereSet = contactsWereSet_.head(nbContacts);
+  contactsTriggered_.head(nbContacts) =
+      (filtered > schmittTrigger_.upperThreshold) || (wereSet && filtered > schmittTrigger_.lowerThreshold);
+
+  for(auto & contact : listContacts_) { contact.forceNorm(filtered(contact.id())); }
 }
 
 template<typename ContactT>
 template<typename OnAddedContact>
-inline ContactT & ContactsManager<ContactT>::addContactToManager(const std::string & forceSensorName,
+inline ContactT & ContactsManager<ContactT>::addContactToManager(const mc_rbdyn::Robot & robot,
+                                                                 const std::string & forceSensorName,
                                                                  const std::string & surface,
                                                                  [[maybe_unused]] OnAddedContact onAddedContact)
 {
-  const auto [it, inserted] = listContacts_.insert({forceSensorName, ContactT(idx_, forceSensorName, surface)});
+  // we look for the contact before trying to insert it to avoid building a new contact (and its strings) when it is
+  // already in the list, which is the case on most iterations with the contacts detection based on the solver.
+  auto existingContact = contactsIndices_.find(forceSensorName);
+  if(existingContact != contactsIndices_.end()) { return listContacts_[existingContact->second]; }
 
-  ContactT & contact = (*it).second;
-  if(!inserted) { return contact; }
+  // the contacts are referenced by the observers, a reallocation of the list would invalidate them
+  if(listContacts_.size() == listContacts_.capacity())
+  {
+    mc_rtc::log::error_and_throw<std::runtime_error>(
+        "[{}]: Cannot add the contact {}, the storage of the contacts was not reserved for it", observerName_,
+        forceSensorName);
+  }
+
+  // the id of the contact is its index in the list
+  const auto id = static_cast<unsigned>(listContacts_.size());
+  ContactT & contact = listContacts_.emplace_back(id, forceSensorName, surface);
+  const size_t forceSensorIndex = robot.data()->forceSensorsIndex.at(forceSensorName);
+  contact.forceSensorIndex(forceSensorIndex);
+  forceSensorsContacts_[forceSensorIndex] = true;
+  contactsIndices_.emplace(forceSensorName, id);
+  publishContactEvent(contact, ContactEvent::Type::Added);
 
   if constexpr(!std::is_same_v<OnAddedContact, std::nullptr_t>) { onAddedContact(contact); }
-  idx_++;
 
   return contact;
 }
 
 template<typename ContactT>
-template<typename OnNewContact, typename OnMaintainedContact, typename OnAddedContact>
-void ContactsManager<ContactT>::findContactsFromSolver(const mc_control::MCController & ctl,
-                                                       const std::string & robotName,
-                                                       OnNewContact & onNewContact,
-                                                       OnMaintainedContact & onMaintainedContact,
-                                                       OnAddedContact & onAddedContact)
+bool ContactsManager<ContactT>::solverContactsChanged(const std::vector<mc_rbdyn::Contact> & solverContacts) const
+    noexcept
 {
-  const auto & measRobot = ctl.robot(robotName);
-
-  // Filled-up when verbose
-  std::string new_contact_set;
-  bool show_new_contacts = false;
-
-  auto insert_contact = [&, this](const std::string & surfaceName)
+  if(solverContacts.size() != solverContacts_.size()) { return true; }
+  for(size_t i = 0; i < solverContacts.size(); ++i)
   {
-    ContactT & contactWS =
-        addContactToManager(measRobot.frame(surfaceName).forceSensor().name(), surfaceName, onAddedContact);
-    contactWS.forceNorm(measRobot.frame(surfaceName).wrench().force().norm());
-    if(contactWS.forceNorm() > schmittTrigger_.lowerThreshold)
+    const auto & contact = solverContacts[i];
+    const auto & cachedContact = solverContacts_[i];
+    if(contact.r1Index() != cachedContact.r1Index || contact.r2Index() != cachedContact.r2Index
+       || contact.r1Surface() != cachedContact.r1Surface || contact.r2Surface() != cachedContact.r2Surface)
     {
-      if(contactWS.wasAlreadySet())
-      {
-        contactsDetected_ = true;
-        contactWS.isSet(true);
-        onMaintainedContact(contactWS);
-      }
-      else if(contactWS.forceNorm() > schmittTrigger_.upperThreshold)
-      {
-        contactsDetected_ = true;
-        contactWS.isSet(true);
-        show_new_contacts = true;
-        onNewContact(contactWS);
-      }
-      if(verbose_)
-      {
-        if(!new_contact_set.empty()) { new_contact_set += ", "; }
-        new_contact_set += contactWS.name();
-      }
+      return true;
     }
+  }
+  return false;
+}
+
+template<typename ContactT>
+template<typename OnAddedContact>
+void ContactsManager<ContactT>::mapSolverContacts(const mc_control::MCController & ctl,
+                                                  const mc_rbdyn::Robot & measRobot,
+                                                  OnAddedContact & onAddedContact)
+{
+  solverContacts_.clear();
+  solverContactsIds_.clear();
+
+  auto map_contact = [&, this](const std::string & surfaceName)
+  {
+    const ContactT & contact =
+        addContactToManager(measRobot, measRobot.frame(surfaceName).forceSensor().name(), surfaceName, onAddedContact);
+    solverContactsIds_.push_back(contact.id());
   };
 
   for(const auto & contact : ctl.solver().contacts())
   {
+    solverContacts_.push_back({contact.r1Index(), contact.r2Index(), contact.r1Surface(), contact.r2Surface()});
 
     const auto & r1 = ctl.robots().robot(contact.r1Index());
     const auto & r2 = ctl.robots().robot(contact.r2Index());
     if(r1.name() == measRobot.name())
     {
 
-      if(r2.mb().nrDof() == 0) { insert_contact(contact.r1Surface()->name()); }
+      if(r2.mb().nrDof() == 0) { map_contact(contact.r1Surface()->name()); }
     }
     else if(r2.name() == measRobot.name())
     {
-      if(r1.mb().nrDof() == 0) { insert_contact(contact.r2Surface()->name()); }
+      if(r1.mb().nrDof() == 0) { map_contact(contact.r2Surface()->name()); }
     }
   }
+}
+
+template<typename ContactT>
+template<typename OnNewContact, typename OnMaintainedContact, typename OnAddedContact>
+void ContactsManager<ContactT>::findContactsFromSolver(const mc_control::MCController & ctl,
+                                                       const std::string & robotName,
+                                                       OnNewContact & onNewContact,
+                                                       OnMaintainedContact & onMaintainedContact,
+                                                       OnAddedContact & onAddedContact)
+{
+  const auto & measRobot = ctl.robot(robotName);
+
+  // the mapping is rebuilt only when the contacts of the solver change, which doesn't happen on most iterations
+  if(solverContactsChanged(ctl.solver().contacts())) { mapSolverContacts(ctl, measRobot, onAddedContact); }
+
+  // the forces of all the contacts are filtered, even the ones that are not in the solver anymore, so their filtered
+  // value is continuous if they are added back. The norm of the force is the same in the frame of the sensor and in
+  // the frame of the surface.
+  thresholdContactsForces(measRobot);
+
+  bool show_new_contacts = false;
+
+  for(const unsigned id : solverContactsIds_)
+  {
+    applyContactTrigger(listContacts_[id], onNewContact, onMaintainedContact, show_new_contacts);
+  }
 
-  if(verbose_ && show_new_contacts) { mc_rtc::log::info("[{}] Contacts changed: {}", observerName_, new_contact_set); }
+  if(verbose_ && show_new_contacts) { logSetContacts(); }
 }
 
 template<typename ContactT>
@@ -254,40 +334,16 @@ void ContactsManager<ContactT>::findContactsFromSurfaces(const mc_control::MCCon
 {
   const auto & measRobot = ctl.robot(robotName);
 
-  // Filled-up when verbose
-  std::string new_contact_set;
   bool show_new_contacts = false;
 
-  for(auto & [_, contact] : contacts())
-  {
-    const std::string & fsName = contact.forceSensor();
-    const mc_rbdyn::ForceSensor & forceSensor = measRobot.forceSensor(fsName);
-    contact.forceNorm(forceSensor.wrenchWithoutGravity(measRobot).force().norm());
-    if(contact.forceNorm() > schmittTrigger_.lowerThreshold)
-    {
-      if(contact.wasAlreadySet())
-      {
-        contactsDetected_ = true;
-        contact.isSet(true);
-        onMaintainedContact(contact);
-      }
-      else if(contact.forceNorm() > schmittTrigger_.upperThreshold)
-      {
-        contactsDetected_ = true;
-        contact.isSet(true);
+  thresholdContactsForces(measRobot);
 
-        show_new_contacts = true;
-        onNewContact(contact);
-      }
-      if(verbose_)
-      {
-        if(!new_contact_set.empty()) { new_contact_set += ", "; }
-        new_contact_set += contact.name();
-      }
-    }
+  for(auto & contact : contacts())
+  {
+    applyContactTrigger(contact, onNewContact, onMaintainedContact, show_new_contacts);
   }
 
-  if(verbose_ && show_new_contacts) { mc_rtc::log::info("[{}] Contacts changed: {}", observerName_, new_contact_set); }
+  if(verbose_ && show_new_contacts) { logSetContacts(); }
 }
 
 template<typename ContactT>
@@ -300,6 +356,19 @@ void ContactsManager<ContactT>::findContactsFromSensors(const mc_control::MCCont
   findContactsFromSurfaces(ctl, robotName, onNewContact, onMaintainedContact);
 }
 
+template<typename ContactT>
+void ContactsManager<ContactT>::logSetContacts() const
+{
+  std::string set_contacts;
+  for(const auto & contact : listContacts_)
+  {
+    if(!contact.isSet()) { continue; }
+    if(!set_contacts.empty()) { set_contacts += ", "; }
+    set_contacts += contact.name();
+  }
+  mc_rtc::log::info("[{}] Contacts changed: {}", observerName_, set_contacts);
+}
+
 template<typename ContactT>
 void ContactsManager<ContactT>::addToLogger(mc_rtc::Logger & logger, const std::string & category)
 {
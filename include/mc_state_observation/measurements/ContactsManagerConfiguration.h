@@ -32,11 +32,20 @@ struct ContactsManagerConfigurationPrvt
     verbose_ = verbose;
     return static_cast<ConfigurationType &>(*this);
   }
+  /// @brief Low-pass filters the measured forces before their thresholding by the Schmitt trigger, to avoid the
+  /// flickering of the contacts due to the chattering of the measurements.
+  /// @param timeConstant Time constant (s) of the first-order filter. The filter is disabled if zero.
+  inline ConfigurationType & forcesFilterTimeConstant(double timeConstant) noexcept
+  {
+    forcesFilterTimeConstant_ = timeConstant;
+    return static_cast<ConfigurationType &>(*this);
+  }
 
   std::string observerName_;
 
   double schmittLowerPropThreshold_;
   double schmittUpperPropThreshold_;
+  double forcesFilterTimeConstant_ = 0.0;
   bool verbose_ = true;
 };
 } // namespace internal
@@ -1,6 +1,7 @@
 #pragma once
 #include <mc_state_observation/measurements/ContactsManager.h>
 #include <mc_state_observation/measurements/measurements.h>
+#include <mc_state_observation/pipeline/KinematicsCache.h>
 #include <state-observation/tools/rigid-body-kinematics.hpp>
 
 namespace mc_state_observation::odometry
@@ -280,20 +281,26 @@ protected:
   /// @brief Adaptation of the structure ContactsManager to the legged odometry, using personalized contacts classes.
   struct LeggedOdometryContactsManager : public ContactsManager
   {
-  protected:
-    // comparison function that sorts the contacts based on their measured force.
-    struct sortByForce
-    {
-      inline bool operator()(const LoContactWithSensor & contact1, const LoContactWithSensor & contact2) const noexcept
-      {
-        return (contact1.forceNorm() < contact2.forceNorm());
-      }
-    };
+  public:
+    /// @brief Sets the maximum number of contacts used for the orientation odometry and allocates their list.
+    void maxOriOdometryContacts(size_t maxOriOdometryContacts);
+
+    /// @brief Adds the contact to the contacts used for the orientation odometry if it is among the ones with the
+    /// highest measured force. The contact with the lowest force is removed if the list is full.
+    /// @details The list has a fixed capacity and is kept sorted, so the selection never allocates.
+    void selectForOrientation(LoContactWithSensor & contact);
+
+    inline size_t maxOriOdometryContacts() const noexcept { return maxOriOdometryContacts_; }
 
   public:
-    // list of contacts used for the orientation odometry. At most two contacts can be used for this estimation, and
-    // contacts at hands are not considered. The contacts with the highest measured force are used.
-    std::set<std::reference_wrapper<LoContactWithSensor>, sortByForce> oriOdometryContacts_;
+    // list of contacts used for the orientation odometry, sorted from the lowest to the highest measured force. At most
+    // maxOriOdometryContacts_ contacts can be used for this estimation, and contacts at hands are not considered. The
+    // contacts with the highest measured force are used.
+    std::vector<LoContactWithSensor *> oriOdometryContacts_;
+
+  protected:
+    // maximum number of contacts used for the orientation odometry
+    size_t maxOriOdometryContacts_ = 2;
   };
 
 public:
@@ -356,11 +363,16 @@ public:
 
     // Indicates if the orientation must be estimated by this odometry.
     bool withYaw_ = true;
+    // Maximum number of contacts used for the estimation of the orientation, the ones with the highest force are used.
+    size_t maxOriContacts_ = 2;
     // Indicates if the reference pose of the contacts must be corrected at the end of each iteration.
     bool correctContacts_ = true;
     // If true, adds the possiblity to switch between 6d and flat odometry from the gui.
     // Should be set to false if this feature is implemented in the estimator using this library.
     bool withModeSwitchInGui_ = true;
+    // If true, the log entries of all the contacts are added once and kept, instead of being added and removed each
+    // time a contact is set or removed.
+    bool withPreRegisteredContactLogs_ = false;
     // Indicates if we want to update the velocity and what method it must be updated with.
     VelocityUpdate velocityUpdate_ = LeggedOdometryManager::VelocityUpdate::NoUpdate;
 
@@ -374,11 +386,21 @@ public:
       withYaw_ = withYaw;
       return *this;
     }
+    inline Configuration & maxOrientationContacts(size_t maxOriContacts) noexcept
+    {
+      maxOriContacts_ = maxOriContacts;
+      return *this;
+    }
     inline Configuration & correctContacts(bool correctContacts) noexcept
     {
       correctContacts_ = correctContacts;
       return *this;
     }
+    inline Configuration & withPreRegisteredContactLogs(bool withPreRegisteredContactLogs) noexcept
+    {
+      withPreRegisteredContactLogs_ = withPreRegisteredContactLogs;
+      return *this;
+    }
 
     /// @brief Sets the velocity update method used in the odometry.
     /// @details Allows to set the velocity update method directly from a string, most likely obtained from a
@@ -508,9 +530,10 @@ public:
 
   /*! \brief Add the odometry to the logger
    *
+   * @param ctl Controller
    * @param category Category in which to log the odometry
    */
-  void addToLogger(mc_rtc::Logger &, const std::string & category);
+  void addToLogger(const mc_control::MCController & ctl, mc_rtc::Logger &, const std::string & category);
 
 private:
   /// @brief Updates the pose of the contacts and estimates the associated kinematics.
@@ -628,6 +651,8 @@ private:
   void updatePositionOdometry();
 
   /// @brief Add the log entries corresponding to the contact.
+  /// @details If the contact logs are pre-registered, called only once per contact, when it is added to the manager or
+  /// when the odometry is added to the logger. The isSet entry then indicates if the logged values are valid.
   /// @param logger
   /// @param contactName
   void addContactLogEntries(const mc_control::MCController & ctl,
@@ -662,6 +687,8 @@ protected:
   LeggedOdometryContactsManager contactsManager_;
   // odometry robot that is updated by the legged odometry and can then update the real robot if required.
   std::shared_ptr<mc_rbdyn::Robots> odometryRobot_;
+  // kinematics shared with the other observers of the pipeline, used to update the joints of the odometry robot
+  pipeline::KinematicsCache * kinematicsCache_ = nullptr;
   // tracked kinematics of the floating base
   stateObservation::kine::Kinematics fbKine_;
 
@@ -681,6 +708,9 @@ protected:
   bool withYawEstimation_;
   // Indicates if the reference pose of the contacts must be corrected at the end of each iteration.
   bool correctContacts_ = true;
+  // Indicates if the log entries of the contacts are added once and kept, instead of being added and removed each time
+  // a contact is set or removed.
+  bool withPreRegisteredContactLogs_ = false;
 
   // position of the anchor point of the robot in the world
   stateObservation::Vector3 worldAnchorPos_;
@@ -72,7 +72,7 @@ void LeggedOdometryManager::initContacts(const mc_control::MCController & ctl,
 
   auto onNewContact = [this, &ctl, &logger, &runParams](LoContactWithSensor & newContact)
   {
-    addContactLogEntries(ctl, logger, newContact);
+    if(!withPreRegisteredContactLogs_) { addContactLogEntries(ctl, logger, newContact); }
 
     newContacts_.push_back(&newContact);
     if constexpr(!std::is_same_v<OnNewContactObserver, std::nullptr_t>) { (*runParams.onNewContactFn)(newContact); }
@@ -115,16 +115,26 @@ void LeggedOdometryManager::initContacts(const mc_control::MCController & ctl,
 
   auto onRemovedContact = [this, &logger, &runParams](LoContactWithSensor & removedContact)
   {
-    removeContactLogEntries(logger, removedContact);
+    if(!withPreRegisteredContactLogs_) { removeContactLogEntries(logger, removedContact); }
     if constexpr(!std::is_same_v<OnRemovedContactObserver, std::nullptr_t>)
     {
       (*runParams.onRemovedContactFn)(removedContact);
     }
   };
 
+  // the log entries of the contacts added to the manager during the run are registered once, on their addition
+  auto onAddedContact = [this, &ctl, &logger, &runParams](LoContactWithSensor & addedContact)
+  {
+    if(withPreRegisteredContactLogs_) { addContactLogEntries(ctl, logger, addedContact); }
+    if constexpr(!std::is_same_v<OnAddedContactObserver, std::nullptr_t>)
+    {
+      (*runParams.onAddedContactFn)(addedContact);
+    }
+  };
+
   // detects the contacts currently set with the environment
   contactsManager().updateContacts(ctl, robotName_, onNewContact, onMaintainedContact, onRemovedContact,
-                                   *runParams.onAddedContactFn);
+                                   onAddedContact);
 
   for(auto * mContact : maintainedContacts_)
   {
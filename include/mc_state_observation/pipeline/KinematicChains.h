@@ -0,0 +1,37 @@
+#pragma once
+
+#include <mc_rbdyn/Robot.h>
+
+namespace mc_state_observation::pipeline
+{
+
+/// @brief Forward kinematics restricted to the kinematic chains going from the floating base to a set of bodies.
+/// @details Observers often read the kinematics of only a few bodies (the parent of the IMU, the bodies of the contact
+/// surfaces), while the full forward kinematics go through all the joints of the robot. The chains leading to the
+/// bodies of interest are computed once, and only their joints are then evaluated. The kinematics of the other bodies
+/// of the robot are left untouched, and thus become outdated.
+class KinematicChains
+{
+public:
+  /// @brief Selects the joints of the chains going from the floating base to the given bodies.
+  /// @details Must be called outside of the real-time loop (configure or reset), as it allocates.
+  /// @param mb Multibody of the robot to update.
+  /// @param bodies Names of the bodies whose kinematics are needed.
+  void init(const rbd::MultiBody & mb, const std::vector<std::string> & bodies);
+
+  /// @brief Copies the configuration of the joints of the chains from the source robot into the robot, except for the
+  /// floating base, and updates the poses and velocities of the bodies of the chains.
+  /// @details The floating base of the robot (q and alpha of its root joint) must be set beforehand.
+  /// @param robot The robot to update. Must have the multibody given to init().
+  /// @param source The robot giving the joint configuration, usually the real robot.
+  void update(mc_rbdyn::Robot & robot, const mc_rbdyn::Robot & source) const;
+
+  /// @brief Number of joints evaluated on each update.
+  inline size_t nrJoints() const noexcept { return joints_.size(); }
+
+private:
+  // indices of the joints of the chains, sorted so that each joint comes after its predecessors
+  std::vector<int> joints_;
+};
+
+} // namespace mc_state_observation::pipeline
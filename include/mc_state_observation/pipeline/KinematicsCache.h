@@ -0,0 +1,71 @@
+#pragma once
+
+#include <mc_control/MCController.h>
+
+#include <unordered_map>
+
+namespace mc_state_observation::pipeline
+{
+
+/// @brief Kinematics of the robots shared by all the observers of a pipeline.
+/// @details Most observers copy the encoder values of the real robot into their own robot and run the forward
+/// kinematics on it, only the floating base differing between them. The cache runs the forward kinematics once per
+/// encoder sample with the floating base at the origin of the world, and the observers obtain their own kinematics from
+/// it by moving only the floating base: the pose and velocity of each body are a rigid transformation of the cached
+/// ones, which is much cheaper than a new pass over the joints. The accelerations are reused only if the floating base
+/// has zero velocity and acceleration, as they are not linear in the velocity of the floating base.
+class KinematicsCache
+{
+public:
+  /// @brief Kinematic quantities to update.
+  enum class Level
+  {
+    /// @brief Poses of the bodies.
+    Position,
+    /// @brief Poses and velocities of the bodies.
+    Velocity,
+    /// @brief Poses, velocities and accelerations of the bodies.
+    Acceleration
+  };
+
+  /// @brief Returns the cache of the current pipeline of the controller, which is created on the first call.
+  /// @details Must be called outside of the real-time loop (configure or reset), as it accesses the datastore.
+  static KinematicsCache & get(const mc_control::MCController & ctl);
+
+  /// @brief Copies the joint configuration of the source robot into the robot, except for the floating base, and
+  /// updates the kinematics of the robot up to the given level.
+  /// @details The floating base of the robot (q, alpha and alphaD of its root joint) must be set beforehand. The
+  /// forward kinematics are computed only if the joint configuration of the source changed since the last call of any
+  /// observer of the pipeline.
+  /// @param robot The robot to update. Must have the same multibody as the source.
+  /// @param source The robot giving the joint configuration, usually the real robot.
+  /// @param level The kinematic quantities to update.
+  void update(mc_rbdyn::Robot & robot, const mc_rbdyn::Robot & source, Level level);
+
+private:
+  /// @brief Kinematics of one robot for the last encoder sample.
+  struct Entry
+  {
+    rbd::MultiBody mb;
+    // configuration with the floating base at the origin of the world, with zero velocity and acceleration
+    rbd::MultiBodyConfig mbc;
+    // pose of each body in the frame of the root body
+    std::vector<sva::PTransformd> rootToBody;
+    // highest level computed for the current sample, if any
+    bool hasPosition = false;
+    bool hasVelocity = false;
+    bool hasAcceleration = false;
+  };
+
+  /// @brief Returns the entry of the source robot, created on the first call.
+  Entry & entry(const mc_rbdyn::Robot & source);
+
+  /// @brief Copies the joint configuration of the source robot into the entry, invalidating the levels whose inputs
+  /// changed, and computes the missing levels.
+  void updateEntry(Entry & entry, const mc_rbdyn::Robot & source, Level level);
+
+private:
+  std::unordered_map<std::string, Entry> entries_;
+};
+
+} // namespace mc_state_observation::pipeline
@@ -0,0 +1,39 @@
+#pragma once
+
+namespace mc_state_observation::profiling
+{
+
+/**
+ * State shared between the observers and the allocation hook of the tests (see tests/test_allocations.cpp), used to
+ * check that the steady-state iterations of the observers don't perform any heap allocation.
+ *
+ * The hook itself is not part of the library: the observers only delimit the calls to third-party code whose
+ * allocations are not under our control (the estimators of the state-observation library) so they can be excluded
+ * from the count.
+ **/
+namespace allocations
+{
+
+/// @brief Starts counting the allocations made by the current thread.
+void startTracking() noexcept;
+
+/// @brief Stops counting the allocations made by the current thread.
+void stopTracking() noexcept;
+
+/// @brief Returns true if the allocations made by the current thread must be counted: the tracking is started and the
+/// thread is not running external code.
+bool tracked() noexcept;
+
+/// @brief Excludes the allocations made during its lifetime from the tracking.
+class ExternalCodeScope
+{
+public:
+  ExternalCodeScope() noexcept;
+  ~ExternalCodeScope();
+  ExternalCodeScope(const ExternalCodeScope &) = delete;
+  ExternalCodeScope & operator=(const ExternalCodeScope &) = delete;
+};
+
+} // namespace allocations
+
+} // namespace mc_state_observation::profiling
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+
+namespace mc_state_observation::profiling
+{
+
+/**
+ * Tools used to measure the computation time of the different stages of the observers, directly on the real-time
+ * thread.
+ **/
+
+/// @brief Lock-free histogram of latencies.
+/// @details The histogram has a single writer (the thread running the observer) and can be read concurrently by any
+/// number of readers (logger, datastore consumers) without locks. The buckets are log-linear: each power of two of
+/// nanoseconds is divided into 8 sub-buckets, which gives a relative resolution of 12.5% on the percentiles over the
+/// whole range while keeping a fixed memory footprint.
+class LatencyHistogram
+{
+public:
+  /// @brief Summary of the recorded latencies, in microseconds.
+  struct Stats
+  {
+    double min = 0.0;
+    double mean = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+    uint64_t count = 0;
+  };
+
+  LatencyHistogram() noexcept { reset(); }
+  LatencyHistogram(const LatencyHistogram &) = delete;
+  LatencyHistogram & operator=(const LatencyHistogram &) = delete;
+
+  /// @brief Adds a new sample to the histogram. Must be called only from the writer thread.
+  /// @param ns the measured latency in nanoseconds
+  inline void record(uint64_t ns) noexcept
+  {
+    buckets_[bucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(ns, std::memory_order_relaxed);
+    if(ns < min_.load(std::memory_order_relaxed)) { min_.store(ns, std::memory_order_relaxed); }
+    if(ns > max_.load(std::memory_order_relaxed)) { max_.store(ns, std::memory_order_relaxed); }
+    // the count is published last so a reader never sees more samples than the ones stored in the buckets
+    count_.fetch_add(1, std::memory_order_release);
+  }
+
+  /// @brief Clears all the recorded samples.
+  inline void reset() noexcept
+  {
+    for(auto & bucket : buckets_) { bucket.store(0, std::memory_order_relaxed); }
+    sum_.store(0, std::memory_order_relaxed);
+    min_.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+    count_.store(0, std::memory_order_release);
+  }
+
+  /// @brief Number of recorded samples.
+  inline uint64_t count() const noexcept { return count_.load(std::memory_order_acquire); }
+  /// @brief Smallest recorded latency, in microseconds.
+  inline double min() const noexcept { return count() == 0 ? 0.0 : toUs(min_.load(std::memory_order_relaxed)); }
+  /// @brief Largest recorded latency, in microseconds.
+  inline double max() const noexcept { return toUs(max_.load(std::memory_order_relaxed)); }
+  /// @brief Average latency, in microseconds.
+  inline double mean() const noexcept
+  {
+    const uint64_t n = count();
+    return n == 0 ? 0.0 : toUs(sum_.load(std::memory_order_relaxed)) / static_cast<double>(n);
+  }
+
+  /// @brief Returns the given percentile of the recorded latencies, in microseconds.
+  /// @details The returned value is the upper bound of the bucket containing the percentile, clamped by the maximum.
+  /// The buckets are scanned downwards from the one of the maximum, so high percentiles only visit a few buckets.
+  /// @param p percentile in [0, 1]
+  inline double percentile(double p) const noexcept
+  {
+    const uint64_t n = count();
+    if(n == 0) { return 0.0; }
+    const uint64_t maxNs = max_.load(std::memory_order_relaxed);
+    // number of samples allowed above the percentile
+    const auto above = static_cast<uint64_t>(static_cast<double>(n) * (1.0 - p));
+    uint64_t cumulated = 0;
+    for(size_t i = bucketIndex(maxNs) + 1; i-- > 0;)
+    {
+      cumulated += buckets_[i].load(std::memory_order_relaxed);
+      if(cumulated > above) { return toUs(std::min(bucketUpperBound(i), maxNs)); }
+    }
+    return toUs(maxNs);
+  }
+
+  /// @brief Returns the min / mean / p99 / max summary of the recorded latencies.
+  inline Stats stats() const noexcept { return {min(), mean(), percentile(0.99), max(), count()}; }
+
+protected:
+  static constexpr unsigned subBucketsBits_ = 3;
+  static constexpr uint64_t subBuckets_ = uint64_t(1) << subBucketsBits_;
+  // values below this threshold have their own bucket
+  static constexpr uint64_t linearRange_ = 2 * subBuckets_;
+  static constexpr size_t nbBuckets_ = linearRange_ + (64 - subBucketsBits_ - 1) * subBuckets_;
+
+  static inline double toUs(uint64_t ns) noexcept { return static_cast<double>(ns) * 1e-3; }
+
+  static inline unsigned highestBit(uint64_t v) noexcept
+  {
+    unsigned b = 0;
+    while(v >>= 1) { ++b; }
+    return b;
+  }
+
+  static inline size_t bucketIndex(uint64_t ns) noexcept
+  {
+    if(ns < linearRange_) { return static_cast<size_t>(ns); }
+    const unsigned e = highestBit(ns);
+    const uint64_t sub = (ns >> (e - subBucketsBits_)) & (subBuckets_ - 1);
+    return static_cast<size_t>(linearRange_ + (e - subBucketsBits_ - 1) * subBuckets_ + sub);
+  }
+
+  static inline uint64_t bucketUpperBound(size_t i) noexcept
+  {
+    if(i < linearRange_) { return i; }
+    const uint64_t e = (i - linearRange_) / subBuckets_ + subBucketsBits_ + 1;
+    const uint64_t sub = (i - linearRange_) % subBuckets_;
+    const uint64_t width = uint64_t(1) << (e - subBucketsBits_);
+    return ((subBuckets_ + sub) << (e - subBucketsBits_)) + width - 1;
+  }
+
+protected:
+  std::array<std::atomic<uint64_t>, nbBuckets_> buckets_;
+  std::atomic<uint64_t> count_;
+  std::atomic<uint64_t> sum_;
+  std::atomic<uint64_t> min_;
+  std::atomic<uint64_t> max_;
+};
+
+/// @brief Measures the time elapsed between its construction and its destruction and records it in a histogram.
+/// @details Does nothing if no histogram is given, which allows to disable the measurements at runtime at the cost of a
+/// single branch.
+class ScopedTimer
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  inline explicit ScopedTimer(LatencyHistogram * histogram) noexcept : histogram_(histogram)
+  {
+    if(histogram_) { start_ = Clock::now(); }
+  }
+  ScopedTimer(const ScopedTimer &) = delete;
+  ScopedTimer & operator=(const ScopedTimer &) = delete;
+
+  inline ~ScopedTimer() { stop(); }
+
+  /// @brief Records the elapsed time now instead of on destruction.
+  inline void stop() noexcept
+  {
+    if(!histogram_) { return; }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start_).count();
+    histogram_->record(static_cast<uint64_t>(elapsed));
+    histogram_ = nullptr;
+  }
+
+private:
+  LatencyHistogram * histogram_;
+  Clock::time_point start_;
+};
+
+} // namespace mc_state_observation::profiling
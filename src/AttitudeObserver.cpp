@@ -13,10 +13,52 @@ constexpr unsigned AttitudeObserver::INPUT_SIZE;
 
 namespace so = stateObservation;
 
+namespace
+{
+/// Left Jacobian of the exponential map of SO(3) at the rotation vector phi.
+/// The right Jacobian at phi is the left one at -phi.
+so::Matrix3 leftJacobian(const so::Vector3 & phi)
+{
+  const double angle = phi.norm();
+  const so::Matrix3 phiHat = so::kine::skewSymmetric(phi);
+  // we use the Taylor expansions of the coefficients for small angles
+  double a, b;
+  if(angle < 1e-4)
+  {
+    a = 0.5 - angle * angle / 24;
+    b = 1.0 / 6 - angle * angle / 120;
+  }
+  else
+  {
+    a = (1 - std::cos(angle)) / (angle * angle);
+    b = (angle - std::sin(angle)) / (angle * angle * angle);
+  }
+  return so::Matrix3::Identity() + a * phiHat + b * phiHat * phiHat;
+}
+
+/// Inverse of the left Jacobian of the exponential map of SO(3) at the rotation vector phi.
+so::Matrix3 leftJacobianInverse(const so::Vector3 & phi)
+{
+  const double angle = phi.norm();
+  const so::Matrix3 phiHat = so::kine::skewSymmetric(phi);
+  double c;
+  if(angle < 1e-4) { c = 1.0 / 12 + angle * angle / 720; }
+  else
+  {
+    // we use (1 + cos(angle)) / sin(angle) = cos(angle / 2) / sin(angle / 2), whose denominator doesn't vanish when
+    // the angle reaches pi
+    const double halfAngle = 0.5 * angle;
+    c = 1 / (angle * angle) - std::cos(halfAngle) / (2 * angle * std::sin(halfAngle));
+  }
+  return so::Matrix3::Identity() - 0.5 * phiHat + c * phiHat * phiHat;
+}
+} // namespace
+
 AttitudeObserver::AttitudeObserver(const std::string & type, double dt)
 : mc_observers::Observer(type, dt), filter_(STATE_SIZE, MEASUREMENT_SIZE, INPUT_SIZE, false),
   q_(so::Matrix::Identity(STATE_SIZE, STATE_SIZE) * defaultConfig_.stateCov),
-  r_(so::Matrix::Identity(MEASUREMENT_SIZE, MEASUREMENT_SIZE) * defaultConfig_.acceleroCovariance), uk_(INPUT_SIZE),
+  r_(so::Matrix::Identity(MEASUREMENT_SIZE, MEASUREMENT_SIZE) * defaultConfig_.acceleroCovariance),
+  a_(so::Matrix::Zero(STATE_SIZE, STATE_SIZE)), c_(so::Matrix::Zero(MEASUREMENT_SIZE, STATE_SIZE)), uk_(INPUT_SIZE),
   xk_(STATE_SIZE)
 {
   /// initialization of the extended Kalman filter
@@ -26,6 +68,17 @@ AttitudeObserver::AttitudeObserver(const std::string & type, double dt)
   Kdt_ << -10, 0, 0, 0, -10, 0, 0, 0, -10;
   Kpo_ << -0.0, 0, 0, 0, -0.0, 0, 0, 0, -10;
   Kdo_ << -0.0, 0, 0, 0, -0.0, 0, 0, 0, -10;
+
+  /// constant blocks of the Jacobian of the state dynamics: the translation and the angular velocity are integrated
+  /// with constant accelerations, which are then replaced by the inputs.
+  const so::Matrix3 I = so::Matrix3::Identity();
+  a_.block<3, 3>(indexes::pos, indexes::pos) = I;
+  a_.block<3, 3>(indexes::pos, indexes::linVel) = dt_ * I;
+  a_.block<3, 3>(indexes::pos, indexes::linAcc) = 0.5 * dt_ * dt_ * I;
+  a_.block<3, 3>(indexes::linVel, indexes::linVel) = I;
+  a_.block<3, 3>(indexes::linVel, indexes::linAcc) = dt_ * I;
+  a_.block<3, 3>(indexes::angVel, indexes::angVel) = I;
+  a_.block<3, 3>(indexes::angVel, indexes::angAcc) = dt_ * I;
 }
 
 void AttitudeObserver::configure(const mc_control::MCController & ctl, const mc_rtc::Configuration & config)
@@ -46,15 +99,8 @@ void AttitudeObserver::reset(const mc_control::MCController & ctl)
 {
   const auto & c = config_;
 
-  q_.noalias() = so::Matrix::Identity(STATE_SIZE, STATE_SIZE) * c.stateCov;
-  r_.noalias() = so::Matrix::Identity(MEASUREMENT_SIZE, MEASUREMENT_SIZE) * c.acceleroCovariance;
-  q_(9, 9) = q_(10, 10) = q_(11, 11) = c.orientationAccCov;
-  q_(6, 6) = q_(7, 7) = q_(8, 8) = c.linearAccCov;
-  r_(3, 3) = r_(4, 4) = r_(5, 5) = c.gyroCovariance;
-
   filter_.reset();
-  filter_.setQ(q_);
-  filter_.setR(r_);
+  setFilterCovariances(c);
   xk_.setZero();
   if(initFromControl_)
   {
@@ -77,14 +123,8 @@ bool AttitudeObserver::run(const mc_control::MCController & ctl)
   const auto & c = config_;
   bool ret = true;
 
-  q_.noalias() = so::Matrix::Identity(STATE_SIZE, STATE_SIZE) * c.stateCov;
-  r_.noalias() = so::Matrix::Identity(MEASUREMENT_SIZE, MEASUREMENT_SIZE) * c.acceleroCovariance;
-  q_(9, 9) = q_(10, 10) = q_(11, 11) = c.orientationAccCov;
-  q_(6, 6) = q_(7, 7) = q_(8, 8) = c.linearAccCov;
-  r_(3, 3) = r_(4, 4) = r_(5, 5) = c.gyroCovariance;
-
-  filter_.setQ(q_);
-  filter_.setR(r_);
+  /// the covariances are given again to the filter only if they were changed (GUI, etc...)
+  if(c.covariancesDiffer(filterCovariancesConfig_)) { setFilterCovariances(c); }
 
   if(lastStateInitCovariance_ != c.stateInitCov) /// if the value of the state Init Covariance has changed
   {
@@ -124,11 +164,20 @@ bool AttitudeObserver::run(const mc_control::MCController & ctl)
   filter_.setInput(uk_, time);
   filter_.setMeasurement(measurement, time + 1);
 
-  /// set the derivation step for the finite difference method
-  const so::Vector dx = filter_.stateVectorConstant(1) * 1e-8;
+  if(c.analyticalJacobians)
+  {
+    computeJacobians();
+    filter_.setA(a_);
+    filter_.setC(c_);
+  }
+  else
+  {
+    /// set the derivation step for the finite difference method
+    const so::Vector dx = filter_.stateVectorConstant(1) * 1e-8;
 
-  filter_.setA(filter_.getAMatrixFD(dx));
-  filter_.setC(filter_.getCMatrixFD(dx));
+    filter_.setA(filter_.getAMatrixFD(dx));
+    filter_.setC(filter_.getCMatrixFD(dx));
+  }
 
   /// get the estimation and give it to the array
   xk_ = filter_.getEstimatedState(time + 1);
@@ -140,6 +189,53 @@ bool AttitudeObserver::run(const mc_control::MCController & ctl)
   return ret;
 }
 
+void AttitudeObserver::setFilterCovariances(const KalmanFilterConfig & c)
+{
+  q_.setIdentity();
+  q_ *= c.stateCov;
+  r_.setIdentity();
+  r_ *= c.acceleroCovariance;
+  q_(9, 9) = q_(10, 10) = q_(11, 11) = c.orientationAccCov;
+  q_(6, 6) = q_(7, 7) = q_(8, 8) = c.linearAccCov;
+  r_(3, 3) = r_(4, 4) = r_(5, 5) = c.gyroCovariance;
+
+  filter_.setQ(q_);
+  filter_.setR(r_);
+  filterCovariancesConfig_ = c;
+}
+
+void AttitudeObserver::computeJacobians()
+{
+  /// the state dynamics rotate the orientation by the increment obtained from the angular velocity and acceleration:
+  /// R_{k+1} = exp(increment) R_k
+  const so::Vector3 ori = xk_.segment<3>(indexes::ori);
+  const so::Vector3 increment =
+      dt_ * xk_.segment<3>(indexes::angVel) + 0.5 * dt_ * dt_ * xk_.segment<3>(indexes::angAcc);
+  const so::Matrix3 predictedR =
+      so::kine::rotationVectorToRotationMatrix(increment) * so::kine::rotationVectorToRotationMatrix(ori);
+  const so::Vector3 predictedOri = so::kine::rotationMatrixToRotationVector(predictedR);
+
+  /// the derivatives of the new rotation vector are obtained from the right (wrt the current orientation) and left (wrt
+  /// the increment) Jacobians of the exponential map
+  const so::Matrix3 dOri_dIncrement = leftJacobianInverse(predictedOri) * leftJacobian(increment);
+  a_.block<3, 3>(indexes::ori, indexes::ori) = leftJacobianInverse(-predictedOri) * leftJacobian(-ori);
+  a_.block<3, 3>(indexes::ori, indexes::angVel) = dt_ * dOri_dIncrement;
+  a_.block<3, 3>(indexes::ori, indexes::angAcc) = 0.5 * dt_ * dt_ * dOri_dIncrement;
+
+  /// the measurements are predicted from the predicted state, whose accelerations are the inputs:
+  /// y = [R^T (linAcc + g), R^T angVel]
+  const so::Matrix3 predictedRt = predictedR.transpose();
+  const so::Vector3 predictedAcc = predictedRt * (uk_.head<3>() + so::cst::gravityConstant * so::Vector3::UnitZ());
+  const so::Vector3 predictedAngVel =
+      predictedRt * (xk_.segment<3>(indexes::angVel) + dt_ * xk_.segment<3>(indexes::angAcc));
+  const so::Matrix3 rightJacobian = leftJacobian(-predictedOri);
+
+  c_.block<3, 3>(0, indexes::linAcc) = predictedRt;
+  c_.block<3, 3>(0, indexes::ori) = so::kine::skewSymmetric(predictedAcc) * rightJacobian;
+  c_.block<3, 3>(3, indexes::ori) = so::kine::skewSymmetric(predictedAngVel) * rightJacobian;
+  c_.block<3, 3>(3, indexes::angVel) = predictedRt;
+}
+
 void AttitudeObserver::update(mc_control::MCController & ctl)
 {
   auto & robot = ctl.robot(robot_);
@@ -184,6 +280,13 @@ void AttitudeObserver::addToGUI(const mc_control::MCController & ctl,
                      { return mc_rbdyn::rpyFromMat(m_orientation.transpose()) * 180. / mc_rtc::constants::PI; }));
 }
 
+bool AttitudeObserver::KalmanFilterConfig::covariancesDiffer(const KalmanFilterConfig & other) const
+{
+  return acceleroCovariance != other.acceleroCovariance || gyroCovariance != other.gyroCovariance
+         || orientationAccCov != other.orientationAccCov || linearAccCov != other.linearAccCov
+         || stateCov != other.stateCov;
+}
+
 void AttitudeObserver::KalmanFilterConfig::addToLogger(mc_rtc::Logger & logger, const std::string & category)
 {
   logger.addLogEntry(category + "_covariance_state", [this]() { return stateCov; });
@@ -212,6 +315,7 @@ void AttitudeObserver::KalmanFilterConfig::addToGUI(mc_rtc::gui::StateBuilder &
     mc_state_observation::gui::make_input_element("linearAccCov", linearAccCov),
     mc_state_observation::gui::make_input_element("stateCov", stateCov),
     mc_state_observation::gui::make_input_element("stateInitCov", stateInitCov),
+    mc_state_observation::gui::make_input_element("analyticalJacobians", analyticalJacobians),
     mc_state_observation::gui::make_rpy_input("offset", offset));
   // clang-format on
 }
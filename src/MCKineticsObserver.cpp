@@ -11,10 +11,24 @@ namespace so = stateObservation;
 namespace mc_state_observation
 {
 MCKineticsObserver::MCKineticsObserver(const std::string & type, double dt)
-: mc_observers::Observer(type, dt), maxContacts_(3), maxIMUs_(1), observer_(maxContacts_, maxIMUs_),
-  tiltObserver_(type, dt, true)
+: mc_observers::Observer(type, dt),
+  observer_(std::make_unique<so::KineticsObserver>(defaultMaxContacts, defaultMaxIMUs)), tiltObserver_(type, dt, true)
 {
-  observer_.setSamplingTime(dt);
+  observer_->setSamplingTime(dt);
+}
+
+MCKineticsObserver::~MCKineticsObserver()
+{
+  // the Kinetics Observer must not be read while it is being updated
+  if(updateWorker_) { updateWorker_->wait(); }
+  // the entries of the datastore access the members of this observer
+  removeFromDatastore();
+  // a diverged or recovering state is not saved, the next start would be initialized with it
+  if(checkpointFile_.empty() || runIter_ == 0 || estimationState_ != noIssue) { return; }
+
+  checkpoint::Checkpoint checkpoint;
+  saveState(checkpoint);
+  checkpoint.trySave(checkpointFile_, name());
 }
 
 ///////////////////////////////////////////////////////////////////////
@@ -23,6 +37,9 @@ MCKineticsObserver::MCKineticsObserver(const std::string & type, double dt)
 
 void MCKineticsObserver::configure(const mc_control::MCController & ctl, const mc_rtc::Configuration & config)
 {
+  // the worker thread is stopped before the Kinetics Observer gets configured again
+  updateWorker_.reset();
+
   tiltObserver_.name(name() + "BackupTiltObserver");
   tiltObserver_.configure(ctl, config);
 
@@ -36,6 +53,29 @@ void MCKineticsObserver::configure(const mc_control::MCController & ctl, const m
   }
   else { listIMUs_.push_back({0, ctl.robot(robot_).bodySensor().name()}); }
 
+  /* Sizing of the Kinetics Observer's state vector */
+  maxContacts_ = defaultMaxContacts;
+  config("maxContacts", maxContacts_);
+  maxIMUs_ = static_cast<unsigned>(listIMUs_.size());
+  config("maxIMUs", maxIMUs_);
+  if(maxIMUs_ < listIMUs_.size())
+  {
+    mc_rtc::log::error_and_throw<std::runtime_error>(
+        "[{}] {} IMUs are used for the estimation but the maximum amount of IMUs is set to {}.", name(),
+        listIMUs_.size(), maxIMUs_);
+  }
+  // the Kinetics Observer can be updated at a lower rate than the controller
+  config("ekfUpdatePeriod", ekfUpdatePeriod_);
+  if(ekfUpdatePeriod_ == 0)
+  {
+    mc_rtc::log::error_and_throw<std::runtime_error>("[{}] The update period of the Kinetics Observer must be at least "
+                                                     "one iteration.",
+                                                     name());
+  }
+  resizeObserver(ctl.timeStep * ekfUpdatePeriod_);
+  config("ekfTimeBudget", ekfTimeBudget_);
+  config("checkpointFile", checkpointFile_);
+
   config("debug", debug_);
   config("verbose", verbose_);
 
@@ -44,7 +84,31 @@ void MCKineticsObserver::configure(const mc_control::MCController & ctl, const m
   std::string typeOfOdometry = static_cast<std::string>(leggedOdomConfig("odometryType"));
   odometryType_ = measurements::stringToOdometryType(typeOfOdometry, name());
 
+#ifndef MC_STATE_OBSERVATION_HEADLESS
   config("withDebugLogs", withDebugLogs_);
+#else
+  if(config("withDebugLogs", false))
+  {
+    mc_rtc::log::warning("[{}]: The debug logs are compiled out of the headless build, they are disabled.", name());
+  }
+#endif
+  config("withStageTimings", withStageTimings_);
+  config("withPreRegisteredContactLogs", withPreRegisteredContactLogs_);
+
+  // the update of the Kinetics Observer can run on a worker thread, its results are then used on the next iteration
+  if(config("asyncUpdate", false))
+  {
+#ifndef MC_STATE_OBSERVATION_HEADLESS
+    // the debug logs read the Kinetics Observer directly, which would race with its update
+    if(withDebugLogs_)
+    {
+      mc_rtc::log::warning("[{}]: The debug logs are not available with the asynchronous update, they are disabled.",
+                           name());
+      withDebugLogs_ = false;
+    }
+#endif
+    updateWorker_ = std::make_unique<concurrency::AsyncWorker>([this]() { updateEstimation(); });
+  }
 
   /* configuration of the contacts manager */
   auto contactsConfig = config("contacts");
@@ -54,6 +118,20 @@ void MCKineticsObserver::configure(const mc_control::MCController & ctl, const m
       contactsManager_.stringToContactsDetection(contactsDetectionString, name());
 
   contactsConfig("forceSensorsAsInput", forceSensorsAsInput_);
+  // the force sensors are retrieved by their index on each iteration
+  forceSensorsAsInputIndices_.clear();
+  for(const std::string & fsName : forceSensorsAsInput_)
+  {
+    forceSensorsAsInputIndices_.push_back(ctl.robot(robot_).data()->forceSensorsIndex.at(fsName));
+  }
+
+  // the measured forces can be low-pass filtered before the contacts detection to avoid the flickering of the contacts,
+  // each new contact resetting its state in the Kinetics Observer
+  double forcesFilterTimeConstant = 0.0;
+  if(config("withFilteredForcesContactDetection", false))
+  {
+    forcesFilterTimeConstant = config("forcesFilterTimeConstant", 0.01);
+  }
 
   if(contactsDetectionMethod == KoContactsManager::ContactsDetection::Surfaces)
   {
@@ -62,7 +140,7 @@ void MCKineticsObserver::configure(const mc_control::MCController & ctl, const m
 
     measurements::ContactsManagerSurfacesConfiguration contactsConf(name(), surfacesForContactDetection);
 
-    contactsConf.verbose(true);
+    contactsConf.verbose(true).forcesFilterTimeConstant(forcesFilterTimeConstant);
     if(contactsConfig.has("schmittTriggerLowerPropThreshold") && contactsConfig.has("schmittTriggerUpperPropThreshold"))
     {
       double schmittTriggerLowerPropThreshold = contactsConfig("schmittTriggerLowerPropThreshold");
@@ -93,7 +171,8 @@ void MCKineticsObserver::configure(const mc_control::MCController & ctl, const m
   if(contactsDetectionMethod == KoContactsManager::ContactsDetection::Sensors)
   {
     measurements::ContactsManagerSensorsConfiguration contactsConf(name());
-    contactsConf.verbose(true).forceSensorsToOmit(forceSensorsAsInput_);
+    contactsConf.verbose(true).forcesFilterTimeConstant(forcesFilterTimeConstant);
+    contactsConf.forceSensorsToOmit(forceSensorsAsInput_);
     if(contactsConfig.has("schmittTriggerLowerPropThreshold") && contactsConfig.has("schmittTriggerUpperPropThreshold"))
     {
       double schmittTriggerLowerPropThreshold = contactsConfig("schmittTriggerLowerPropThreshold");
@@ -119,7 +198,7 @@ void MCKineticsObserver::configure(const mc_control::MCController & ctl, const m
   if(contactsDetectionMethod == KoContactsManager::ContactsDetection::Solver)
   {
     measurements::ContactsManagerSolverConfiguration contactsConf(name());
-    contactsConf.verbose(true);
+    contactsConf.verbose(true).forcesFilterTimeConstant(forcesFilterTimeConstant);
     if(contactsConfig.has("schmittTriggerLowerPropThreshold") && contactsConfig.has("schmittTriggerUpperPropThreshold"))
     {
       double schmittTriggerLowerPropThreshold = contactsConfig("schmittTriggerLowerPropThreshold");
@@ -129,26 +208,35 @@ void MCKineticsObserver::configure(const mc_control::MCController & ctl, const m
     contactsManager_.init(ctl, robot_, contactsConf);
   }
 
+  // the id of the contacts is used as their index in the state vector of the Kinetics Observer
+  if(contactsManager_.contacts().size() > maxContacts_)
+  {
+    mc_rtc::log::error_and_throw<std::runtime_error>(
+        "[{}] {} contacts can be detected but the maximum amount of contacts is set to {}, please increase "
+        "maxContacts.",
+        name(), contactsManager_.contacts().size(), maxContacts_);
+  }
+
   /* Configuration of the Kinetics Observer's parameters */
 
   config("withUnmodeledWrench", withUnmodeledWrench_);
   config("withGyroBias", withGyroBias_);
 
-  observer_.setWithUnmodeledWrench(withUnmodeledWrench_);
-  observer_.setWithGyroBias(withGyroBias_);
+  observer_->setWithUnmodeledWrench(withUnmodeledWrench_);
+  observer_->setWithGyroBias(withGyroBias_);
   bool useFiniteDifferences = config("withFiniteDifferences");
   if(useFiniteDifferences)
   {
-    observer_.useFiniteDifferencesJacobians(useFiniteDifferences);
-    so::Vector dx(observer_.getStateSize());
+    observer_->useFiniteDifferencesJacobians(useFiniteDifferences);
+    so::Vector dx(observer_->getStateSize());
     dx.setConstant(static_cast<double>(config("finiteDifferenceStep")));
-    observer_.setFiniteDifferenceStep(dx);
+    observer_->setFiniteDifferenceStep(dx);
   }
 
-  observer_.setWithAccelerationEstimation(config("withAccelerationEstimation"));
+  observer_->setWithAccelerationEstimation(config("withAccelerationEstimation"));
   if(config.has("withAdaptativeContactProcessCov"))
   {
-    observer_.setWithAdaptativeContactProcessCov(config("withAdaptativeContactProcessCov"));
+    observer_->setWithAdaptativeContactProcessCov(config("withAdaptativeContactProcessCov"));
   }
 
   linStiffness_ = (config("linStiffness").operator so::Vector3()).matrix().asDiagonal();
@@ -218,7 +306,7 @@ void MCKineticsObserver::configure(const mc_control::MCController & ctl, const m
   contactProcessCovariance_.setZero();
   // if we stick to the control robot's anchor frame, we don't allow the correction of the contacts pose
 
-  if(observer_.getWithAdaptativeContactProcessCov())
+  if(observer_->getWithAdaptativeContactProcessCov())
   {
     contactProcessCovariance_.block<3, 3>(0, 0) =
         (ekfStateProcessVariances("contactPositionProcessVariance").operator so::Vector3()).matrix().asDiagonal();
@@ -284,44 +372,98 @@ void MCKineticsObserver::configure(const mc_control::MCController & ctl, const m
   koBackupFbKinematics_.set_capacity(fbBackupCapacity_);
   tiltObserver_.backupFbKinematics_.set_capacity(fbBackupCapacity_);
 
-  invincibilityFrame_ = int(1.5 / ctl.timeStep);
+  // the invincibility frame is counted in updates of the Kinetics Observer
+  invincibilityFrame_ = int(1.5 / (ctl.timeStep * ekfUpdatePeriod_));
 
+#ifndef MC_STATE_OBSERVATION_HEADLESS
   std::vector<std::string> nanBehaviourCategory;
   nanBehaviourCategory.insert(nanBehaviourCategory.end(), {"ObserverPipelines", ctl.observerPipeline().name(), name()});
   ctl.gui()->addElement({nanBehaviourCategory},
-                        mc_rtc::gui::Button("SimulateNanBehaviour", [this]() { observer_.nanDetected_ = true; }));
+                        mc_rtc::gui::Button("SimulateNanBehaviour", [this]() { nanSimulationRequested_ = true; }));
+#endif
+
+  // the entries of a previous configuration are removed, they are all registered again below
+  removeFromDatastore();
+  datastore_ = &(const_cast<mc_control::MCController &>(ctl)).datastore();
+  auto & datastore = *datastore_;
+
+  // the computation times of the stages of run() can be read by other components through the datastore
+  if(withStageTimings_)
+  {
+    for(size_t i = 0; i < nbRunStages; ++i)
+    {
+      const std::string entryName = name() + "::RunStageTimings::" + runStagesNames_[i];
+      if(datastore.has(entryName)) { datastore.remove(entryName); }
+      datastore.make_call(entryName,
+                          [this, i]() -> const profiling::LatencyHistogram & { return runStageTimings_[i]; });
+    }
+  }
+
+  // delay of the estimation with respect to the measurements, non-zero only with the asynchronous update
+  if(datastore.has(name() + "::EstimationLatency")) { datastore.remove(name() + "::EstimationLatency"); }
+  datastore.make_call(name() + "::EstimationLatency", [this]() -> double { return estimationLatency_; });
+
+  // the transitions of the contacts can be polled by other components (logging, planning) outside the real-time loop
+  if(datastore.has(name() + "::ContactEvents")) { datastore.remove(name() + "::ContactEvents"); }
+  datastore.make_call(name() + "::ContactEvents",
+                      [this]() -> const measurements::ContactEvents & { return contactsManager_.contactEvents(); });
+
+  // absolute measurements of the pose of the floating base (SLAM, motion capture) can be given with the number of
+  // iterations elapsed since they were taken. They must be given from the controller's thread, before the run of the
+  // observer.
+  if(datastore.has(name() + "::DelayedAbsolutePose")) { datastore.remove(name() + "::DelayedAbsolutePose"); }
+  datastore.make_call(name() + "::DelayedAbsolutePose",
+                      [this](const sva::PTransformd & worldFbPose, unsigned long delay, bool withPosition)
+                      {
+                        delayedPoseMeas_.worldFbKine =
+                            conversions::kinematics::fromSva(worldFbPose, so::kine::Kinematics::Flags::pose);
+                        delayedPoseMeas_.delay = delay;
+                        delayedPoseMeas_.withPosition = withPosition;
+                        delayedPoseMeas_.pending = true;
+                      });
+}
+
+void MCKineticsObserver::resizeObserver(double dt)
+{
+  // The dimensions of the Kinetics Observer are fixed on construction, so we build it again with the new ones. The
+  // current one is kept if the construction fails.
+  observer_ = std::make_unique<so::KineticsObserver>(maxContacts_, maxIMUs_);
+  observer_->setSamplingTime(dt);
 }
 
 void MCKineticsObserver::setObserverCovariances()
 {
   // initialization of the observers covariances
-  observer_.setKinematicsInitCovarianceDefault(statePositionInitCovariance_, stateOriInitCovariance_,
-                                               stateLinVelInitCovariance_, stateAngVelInitCovariance_);
-  observer_.setGyroBiasInitCovarianceDefault(gyroBiasInitCovariance_);
-  observer_.setUnmodeledWrenchInitCovMatDefault(unmodeledWrenchInitCovariance_);
-  observer_.setContactInitCovMatDefault(contactInitCovarianceFirstContacts_);
-  observer_.resetStateCovarianceMat();
-
-  observer_.setKinematicsProcessCovarianceDefault(statePositionProcessCovariance_, stateOriProcessCovariance_,
-                                                  stateLinVelProcessCovariance_, stateAngVelProcessCovariance_);
-  observer_.setGyroBiasProcessCovarianceDefault(gyroBiasProcessCovariance_);
-  observer_.setUnmodeledWrenchProcessCovarianceDefault(unmodeledWrenchProcessCovariance_);
-  observer_.setContactProcessCovarianceDefault(contactProcessCovariance_);
-
-  observer_.resetProcessCovarianceMat();
-
-  observer_.setIMUDefaultCovarianceMatrix(acceleroSensorCovariance_, gyroSensorCovariance_);
-  observer_.setContactWrenchSensorDefaultCovarianceMatrix(contactSensorCovariance_);
+  observer_->setKinematicsInitCovarianceDefault(statePositionInitCovariance_, stateOriInitCovariance_,
+                                                stateLinVelInitCovariance_, stateAngVelInitCovariance_);
+  observer_->setGyroBiasInitCovarianceDefault(gyroBiasInitCovariance_);
+  observer_->setUnmodeledWrenchInitCovMatDefault(unmodeledWrenchInitCovariance_);
+  observer_->setContactInitCovMatDefault(contactInitCovarianceFirstContacts_);
+  observer_->resetStateCovarianceMat();
+
+  observer_->setKinematicsProcessCovarianceDefault(statePositionProcessCovariance_, stateOriProcessCovariance_,
+                                                   stateLinVelProcessCovariance_, stateAngVelProcessCovariance_);
+  observer_->setGyroBiasProcessCovarianceDefault(gyroBiasProcessCovariance_);
+  observer_->setUnmodeledWrenchProcessCovarianceDefault(unmodeledWrenchProcessCovariance_);
+  observer_->setContactProcessCovarianceDefault(contactProcessCovariance_);
+
+  observer_->resetProcessCovarianceMat();
+
+  observer_->setIMUDefaultCovarianceMatrix(acceleroSensorCovariance_, gyroSensorCovariance_);
+  observer_->setContactWrenchSensorDefaultCovarianceMatrix(contactSensorCovariance_);
   so::Matrix6 absPoseSensorDefCovariance = so::Matrix6::Zero();
-  absPoseSensorDefCovariance.block(0, 0, observer_.sizePos, observer_.sizePos) = positionSensorCovariance_;
-  absPoseSensorDefCovariance.block(observer_.sizePos, observer_.sizePos, observer_.sizeOriTangent,
-                                   observer_.sizeOriTangent) = orientationSensorCoVariance_;
-  observer_.setAbsolutePoseSensorDefaultCovarianceMatrix(absPoseSensorDefCovariance);
-  // observer_.setAbsoluteOriSensorDefaultCovarianceMatrix(absoluteOriSensorCovariance_);
+  absPoseSensorDefCovariance.block(0, 0, observer_->sizePos, observer_->sizePos) = positionSensorCovariance_;
+  absPoseSensorDefCovariance.block(observer_->sizePos, observer_->sizePos, observer_->sizeOriTangent,
+                                   observer_->sizeOriTangent) = orientationSensorCoVariance_;
+  observer_->setAbsolutePoseSensorDefaultCovarianceMatrix(absPoseSensorDefCovariance);
+  // observer_->setAbsoluteOriSensorDefaultCovarianceMatrix(absoluteOriSensorCovariance_);
 }
 
 void MCKineticsObserver::reset(const mc_control::MCController & ctl)
 {
+  // the Kinetics Observer must not be modified while it is being updated
+  if(updateWorker_) { updateWorker_->wait(); }
+
   tiltObserver_.reset(ctl);
 
   const auto & robot = ctl.robot(robot_);
@@ -363,18 +505,145 @@ void MCKineticsObserver::reset(const mc_control::MCController & ctl)
   a_fb_0_ = sva::MotionVecd::Zero();
   lastBackupIter_ = 0;
   invincibilityIter_ = 0;
+  runIter_ = 0;
+  lastUpdateIter_ = 0;
+  degradedIters_ = 0;
+  correctedMeasurementsIter_ = koInvalidIter;
+  contactsPosAverageStateCov_.setZero();
+  contactsPosAverageStateCovIter_ = koInvalidIter;
+  for(auto & contact : contactsManager_.contacts()) { contact.viscoElasticWrenchIter_ = koInvalidIter; }
+  for(auto & histogram : runStageTimings_) { histogram.reset(); }
 
   my_robots_ = mc_rbdyn::Robots::make();
+#ifndef MC_STATE_OBSERVATION_HEADLESS
+  // robot displaying the estimation (only a visual feature)
   my_robots_->robotCopy(robot, robot.name());
+#endif
   my_robots_->robotCopy(realRobot, "inputRobot");
+  kinematicsCache_ = &pipeline::KinematicsCache::get(ctl);
+#ifndef MC_STATE_OBSERVATION_HEADLESS
   ctl.gui()->addElement(
       {"Robots"}, mc_rtc::gui::Robot(name(), [this]() -> const mc_rbdyn::Robot & { return my_robots_->robot(); }));
   ctl.gui()->addElement({"Robots"},
                         mc_rtc::gui::Robot("Real", [&ctl]() -> const mc_rbdyn::Robot & { return ctl.realRobot(); }));
+#endif
 
   X_0_fb_ = realRobot.posW().translation();
 
   initObserverStateVector(ctl, realRobot);
+  for(auto & results : updateResults_.buffers())
+  {
+    results.stateVector = observer_->getCurrentStateVector();
+    results.stateCovarianceDiagonal.setZero(observer_->getStateTangentSize());
+    results.nanDetected = false;
+  }
+  estimationLatency_ = 0.0;
+  nanSimulationRequested_ = false;
+  restoredContactRefs_.clear();
+
+  if(checkpointFile_.empty()) { return; }
+  if(auto checkpoint = checkpoint::Checkpoint::tryLoad(checkpointFile_, name()))
+  {
+    if(!restoreState(*checkpoint))
+    {
+      mc_rtc::log::warning("[{}]: the checkpoint doesn't match the configuration of the observer, cold start", name());
+    }
+  }
+}
+
+void MCKineticsObserver::saveState(checkpoint::Checkpoint & checkpoint)
+{
+  const so::Vector & x = observer_->getCurrentStateVector();
+  checkpoint.set(name() + "::x", x);
+  checkpoint.set(name() + "::P", observer_->getStateCovarianceMat());
+  Eigen::Matrix<double, 7, 1> fbPose;
+  fbPose << X_0_fb_.translation(), Eigen::Quaterniond(X_0_fb_.rotation()).coeffs();
+  checkpoint.set(name() + "::fbPose", fbPose);
+  checkpoint.set(name() + "::fbVel", v_fb_0_.vector());
+
+  // reference position and orientation (as a quaternion vector) of the set contacts
+  for(auto & contact : contactsManager_.contacts())
+  {
+    if(!contact.isSet()) { continue; }
+    Eigen::Matrix<double, 7, 1> contactRef;
+    contactRef << x.segment(observer_->contactPosIndex(contact.id()), observer_->sizePos),
+        x.segment(observer_->contactOriIndex(contact.id()), observer_->sizeOri);
+    checkpoint.set(name() + "::contact::" + contact.name(), contactRef);
+  }
+
+  tiltObserver_.saveState(checkpoint, tiltObserver_.name());
+}
+
+bool MCKineticsObserver::restoreState(const checkpoint::Checkpoint & checkpoint)
+{
+  so::Vector x;
+  so::Matrix P;
+  Eigen::Matrix<double, 7, 1> fbPose;
+  so::Vector6 fbVel;
+  if(!checkpoint.get(name() + "::x", x) || !checkpoint.get(name() + "::P", P)
+     || !checkpoint.get(name() + "::fbPose", fbPose) || !checkpoint.get(name() + "::fbVel", fbVel))
+  {
+    return false;
+  }
+  // the size of the state depends on the maximum amounts of contacts and IMUs
+  if(x.size() != observer_->getStateSize() || P.rows() != observer_->getStateTangentSize()
+     || P.cols() != observer_->getStateTangentSize())
+  {
+    return false;
+  }
+  if(!tiltObserver_.restoreState(checkpoint, tiltObserver_.name())) { return false; }
+
+  // the biases of the gyrometers and the unmodeled wrench don't depend on the initial pose of the robot
+  for(const auto & imu : listIMUs_)
+  {
+    observer_->setGyroBias(x.segment(observer_->gyroBiasIndex(imu.id()), observer_->sizeGyroBias),
+                           static_cast<unsigned>(imu.id()), false);
+  }
+  so::Vector6 unmodeledWrench;
+  unmodeledWrench << x.segment(observer_->unmodeledForceIndex(), observer_->sizeForce),
+      x.segment(observer_->unmodeledTorqueIndex(), observer_->sizeTorque);
+  observer_->setStateUnmodeledWrench(unmodeledWrench, false);
+
+  if(odometryType_ == measurements::OdometryType::None) { return true; }
+
+  // with odometry, the estimation continues from the pose of the previous run
+  so::kine::Kinematics worldCentroidKine;
+  worldCentroidKine.position = x.segment(observer_->posIndex(), observer_->sizePos);
+  worldCentroidKine.orientation.fromVector4(x.segment(observer_->oriIndex(), observer_->sizeOri));
+  worldCentroidKine.linVel = x.segment(observer_->linVelIndex(), observer_->sizeLinVel);
+  worldCentroidKine.angVel = x.segment(observer_->angVelIndex(), observer_->sizeAngVel);
+  observer_->setWorldCentroidStateKinematics(worldCentroidKine, false);
+  // the blocks of the contacts are set again when the contacts are added
+  observer_->setStateCovarianceMat(P);
+
+  X_0_fb_ = sva::PTransformd(Eigen::Quaterniond(fbPose.tail<4>()).normalized().toRotationMatrix(), fbPose.head<3>());
+  v_fb_0_ = sva::MotionVecd(fbVel);
+
+  const std::string contactsPrefix = name() + "::contact::";
+  for(const auto & contactName : checkpoint.keys(contactsPrefix))
+  {
+    Eigen::Matrix<double, 7, 1> contactRef;
+    if(!checkpoint.get(contactsPrefix + contactName, contactRef)) { continue; }
+    so::kine::Kinematics & worldContactKineRef = restoredContactRefs_[contactName];
+    worldContactKineRef.position = contactRef.head<3>();
+    worldContactKineRef.orientation.fromVector4(contactRef.tail<4>());
+  }
+
+  return true;
+}
+
+void MCKineticsObserver::removeFromDatastore()
+{
+  if(!datastore_) { return; }
+  auto removeEntry = [this](const std::string & entryName)
+  {
+    if(datastore_->has(entryName)) { datastore_->remove(entryName); }
+  };
+  for(const char * stageName : runStagesNames_) { removeEntry(name() + "::RunStageTimings::" + stageName); }
+  removeEntry(name() + "::EstimationLatency");
+  removeEntry(name() + "::DelayedAbsolutePose");
+  removeEntry(name() + "::ContactEvents");
+  datastore_ = nullptr;
 }
 
 void MCKineticsObserver::addSensorsAsInputs(const mc_rbdyn::Robot & inputRobot,
@@ -382,9 +651,9 @@ void MCKineticsObserver::addSensorsAsInputs(const mc_rbdyn::Robot & inputRobot,
                                             so::Vector3 & inputAddtionalForce,
                                             so::Vector3 & inputAddtionalTorque)
 {
-  for(const std::string & fsName : forceSensorsAsInput_)
+  for(const size_t fsIndex : forceSensorsAsInputIndices_)
   {
-    const mc_rbdyn::ForceSensor & forceSensor = measRobot.forceSensor(fsName);
+    const mc_rbdyn::ForceSensor & forceSensor = measRobot.forceSensors()[fsIndex];
     sva::ForceVecd measuredWrench = forceSensor.worldWrenchWithoutGravity(inputRobot);
 
     inputAddtionalForce += measuredWrench.force();
@@ -394,32 +663,60 @@ void MCKineticsObserver::addSensorsAsInputs(const mc_rbdyn::Robot & inputRobot,
 
 bool MCKineticsObserver::run(const mc_control::MCController & ctl)
 {
-  tiltObserver_.run(ctl);
+  profiling::ScopedTimer totalTimer(stageTimings(totalStage));
+  // the debug variables computed on the previous iteration are now outdated
+  runIter_++;
+
+  {
+    profiling::ScopedTimer timer(stageTimings(tiltObserverStage));
+    tiltObserver_.run(ctl);
+  }
+
+  // in the multi-rate mode, the Kinetics Observer is updated only once every ekfUpdatePeriod_ iterations. The update is
+  // also skipped if it would exceed its time budget. In both cases, the floating base is propagated with the
+  // displacement estimated by the Tilt Observer, and the next update of the Kinetics Observer covers all the skipped
+  // iterations.
+  const bool scheduledUpdate = (runIter_ - 1) % ekfUpdatePeriod_ == 0;
+  const bool degraded = scheduledUpdate && ekfUpdateExceedsBudget();
+  if(degraded) { degradedIters_++; }
+  if(!scheduledUpdate || degraded)
+  {
+    profiling::ScopedTimer floatingBaseTimer(stageTimings(floatingBaseUpdateStage));
+    propagateWithTiltObserver(ctl.timeStep);
+    // the delayed pose measurements are given on the next update
+    if(delayedPoseMeas_.pending) { delayedPoseMeas_.delay++; }
+    floatingBaseTimer.stop();
+
+#ifndef MC_STATE_OBSERVATION_HEADLESS
+    my_robots_->robot().mbc().q = ctl.realRobot().mbc().q;
+    update(my_robots_->robot());
+#endif
+    return true;
+  }
+
+  // in the asynchronous mode, the update triggered on the previous iteration must be finished before we give the new
+  // inputs to the Kinetics Observer. It normally finished during the previous iteration so we don't wait.
+  if(updateWorker_)
+  {
+    profiling::ScopedTimer timer(stageTimings(ekfWaitStage));
+    updateWorker_->wait();
+    updateResults_.acquire();
+  }
 
   const auto & robot = ctl.robot(robot_);
   const auto & realRobot = ctl.realRobot(robot_);
   auto & inputRobot = my_robots_->robot("inputRobot");
   auto & logger = (const_cast<mc_control::MCController &>(ctl)).logger();
 
-  // Copy the real configuration except for the floating base
-  const auto & realQ = realRobot.mbc().q;
-  const auto & realAlpha = realRobot.mbc().alpha;
-  const auto & realAlphaD = realRobot.mbc().alphaD;
-
-  std::copy(std::next(realQ.begin()), realQ.end(), std::next(inputRobot.mbc().q.begin()));
-  std::copy(std::next(realAlpha.begin()), realAlpha.end(), std::next(inputRobot.mbc().alpha.begin()));
-  std::copy(std::next(realAlphaD.begin()), realAlphaD.end(), std::next(inputRobot.mbc().alphaD.begin()));
-
-  inputRobot.forwardKinematics();
-  inputRobot.forwardVelocity();
-  inputRobot.forwardAcceleration();
-
+  profiling::ScopedTimer kinematicsTimer(stageTimings(inputRobotKinematicsStage));
   // The input robot copies the real robot to update the encoder values.
-  // Then its floating base is brung back to the origin of the world frame and given zero velocities and accelerations
-  // in order to ease the computations.
-  inputRobot.posW(zeroPose_);
-  inputRobot.velW(zeroMotion_);
-  inputRobot.accW(zeroMotion_);
+  // Its floating base is brung back to the origin of the world frame and given zero velocities and accelerations in
+  // order to ease the computations. This is the configuration computed by the kinematics cache, which is then only
+  // copied.
+  inputRobot.mbc().q[0] = {1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+  std::fill(inputRobot.mbc().alpha[0].begin(), inputRobot.mbc().alpha[0].end(), 0.0);
+  std::fill(inputRobot.mbc().alphaD[0].begin(), inputRobot.mbc().alphaD[0].end(), 0.0);
+  kinematicsCache_->update(inputRobot, realRobot, pipeline::KinematicsCache::Level::Acceleration);
 
   /** Center of mass (assumes FK, FV and FA are already done)
       Must be initialized now as used for the conversion from user to centroid frame !!! **/
@@ -427,30 +724,64 @@ bool MCKineticsObserver::run(const mc_control::MCController & ctl)
   worldCoMKine_.linVel = inputRobot.comVelocity();
   worldCoMKine_.linAcc = inputRobot.comAcceleration();
 
-  observer_.setCenterOfMass(worldCoMKine_.position(), worldCoMKine_.linVel(), worldCoMKine_.linAcc());
+  observer_->setCenterOfMass(worldCoMKine_.position(), worldCoMKine_.linVel(), worldCoMKine_.linAcc());
+  kinematicsTimer.stop();
+
+  // the update covers all the iterations since the previous one
+  const size_t itersSinceLastUpdate = runIter_ > 1 ? runIter_ - lastUpdateIter_ : ekfUpdatePeriod_;
+  const double samplingTime = ctl.timeStep * static_cast<double>(itersSinceLastUpdate);
 
   // update of the contacts
-  updateContacts(ctl, logger);
+  {
+    profiling::ScopedTimer timer(stageTimings(updateContactsStage));
+    updateContacts(ctl, logger, samplingTime);
+  }
 
   // force measurements from sensor that are not associated to a currently set contact are given to the Kinetics
   // Observer as inputs.
-  inputAdditionalWrench(inputRobot, robot);
+  {
+    profiling::ScopedTimer timer(stageTimings(inputAdditionalWrenchStage));
+    inputAdditionalWrench(inputRobot, robot);
+  }
 
   /** Accelerometers **/
-  updateIMUs(robot, inputRobot);
+  {
+    profiling::ScopedTimer timer(stageTimings(updateIMUsStage));
+    updateIMUs(robot, inputRobot);
+  }
 
-  observer_.setCoMAngularMomentum(
-      rbd::computeCentroidalMomentum(inputRobot.mb(), inputRobot.mbc(), inputRobot.com()).moment());
+  {
+    profiling::ScopedTimer timer(stageTimings(centroidalInputsStage));
+    observer_->setCoMAngularMomentum(
+        rbd::computeCentroidalMomentum(inputRobot.mb(), inputRobot.mbc(), inputRobot.com()).moment());
 
-  observer_.setCoMInertiaMatrix(so::Matrix3(
-      inertiaWaist_.inertia() + observer_.getMass() * so::kine::skewSymmetric2(observer_.getCenterOfMass()())));
+    observer_->setCoMInertiaMatrix(so::Matrix3(
+        inertiaWaist_.inertia() + observer_->getMass() * so::kine::skewSymmetric2(observer_->getCenterOfMass()())));
+  }
+
+  if(delayedPoseMeas_.pending) { inputDelayedPoseMeasurement(ctl); }
 
-  res_ = observer_.update();
+  observer_->setSamplingTime(samplingTime);
+  lastUpdateIter_ = runIter_;
+
+  // in the asynchronous mode, the update is triggered at the end of the iteration and its results are used on the next
+  // one. On the first iteration, there are no previous results so we update synchronously.
+  const bool asyncUpdate = updateWorker_ && runIter_ > 1;
+  if(!asyncUpdate)
+  {
+    updateEstimation();
+    updateResults_.acquire();
+  }
+  const KoUpdateResults & updateResults = updateResults_.front();
+  // the results of the asynchronous update were obtained with the inputs of the previous update
+  estimationLatency_ = asyncUpdate ? samplingTime : 0.0;
+
+  profiling::ScopedTimer floatingBaseTimer(stageTimings(floatingBaseUpdateStage));
 
   // Kinematics of the floating base in the real world frame (our estimation goal)
   so::kine::Kinematics mcko_K_0_fb;
 
-  if(observer_.nanDetected_) { estimationState_ = errorDetected; }
+  if(updateResults.nanDetected || nanSimulationRequested_) { estimationState_ = errorDetected; }
   else if(invincibilityIter_ > 0 && invincibilityIter_ < invincibilityFrame_) { estimationState_ = invincibilityFrame; }
   else { estimationState_ = noIssue; }
 
@@ -461,12 +792,9 @@ bool MCKineticsObserver::run(const mc_control::MCController & ctl)
     case noIssue:
     {
       /* Core */
-      so::kine::Kinematics fbFb; // "Zero" Kinematics
-      fbFb.setZero<so::Matrix3>(so::kine::Kinematics::Flags::all);
-
-      // Given, the Kinematics of the floating base inside its own frame (zero kinematics) which is our user
-      // frame, the Kinetics Observer will return the kinematics of the floating base in the real world frame.
-      mcko_K_0_fb = observer_.getGlobalKinematicsOf(fbFb);
+      mcko_K_0_fb = updateResults.worldFbKine;
+      // the results of the asynchronous update are late by one update period
+      if(asyncUpdate) { compensateLatency(mcko_K_0_fb, estimationLatency_); }
 
       koBackupFbKinematics_.push_back(mcko_K_0_fb);
 
@@ -487,18 +815,7 @@ bool MCKineticsObserver::run(const mc_control::MCController & ctl)
     {
       // we apply the last transformation estimated by the Tilt Observer to our previous pose to keep updating the
       // floating base with the Tilt Observer.
-      mcko_K_0_fb = tiltObserver_.applyLastTransformation(koBackupFbKinematics_.back());
-      koBackupFbKinematics_.push_back(mcko_K_0_fb);
-
-      X_0_fb_.rotation() = mcko_K_0_fb.orientation.toMatrix3().transpose();
-      X_0_fb_.translation() = mcko_K_0_fb.position();
-
-      // the tilt observer doesn't estimate the acceleration so we get it by finite differences
-      a_fb_0_.angular() = (mcko_K_0_fb.angVel() - v_fb_0_.angular()) / ctl.timeStep;
-      a_fb_0_.linear() = (mcko_K_0_fb.linVel() - v_fb_0_.linear()) / ctl.timeStep;
-
-      v_fb_0_.angular() = mcko_K_0_fb.angVel();
-      v_fb_0_.linear() = mcko_K_0_fb.linVel();
+      mcko_K_0_fb = propagateWithTiltObserver(ctl.timeStep);
 
       invincibilityIter_++;
       // While converging again after being reset, the estimation made by the Kinetics Observer is very inaccurate and
@@ -519,14 +836,14 @@ bool MCKineticsObserver::run(const mc_control::MCController & ctl)
         newWorldCentroidKine.linVel = inputRobot.comVelocity();
         newWorldCentroidKine.angVel = mcko_K_0_fb.angVel();
 
-        observer_.setWorldCentroidStateKinematics(newWorldCentroidKine, false);
+        observer_->setWorldCentroidStateKinematics(newWorldCentroidKine, false);
 
-        for(auto & [_, contact] : contactsManager_.contacts())
+        for(auto & contact : contactsManager_.contacts())
         {
           if(!contact.isSet()) { continue; }
 
           // Update of the force measurements (the contribution of the gravity changed)
-          const mc_rbdyn::ForceSensor & forceSensor = robot.forceSensor(contact.forceSensor());
+          const mc_rbdyn::ForceSensor & forceSensor = robot.forceSensors()[contact.forceSensorIndex()];
 
           // the tilt of the robot changed so the contribution of the gravity to the measurements changed too
           if(contactsManager_.getContactsDetection() == KoContactsManager::ContactsDetection::Sensors)
@@ -549,10 +866,10 @@ bool MCKineticsObserver::run(const mc_control::MCController & ctl)
           }
           else // we don't perform odometry, the reference pose of the contact is its pose in the control robot
           {
-            newWorldContactKineRef = getContactWorldKinematics(contact, robot, forceSensor);
+            getContactWorldKinematics(contact, robot, forceSensor, newWorldContactKineRef);
           }
 
-          observer_.setStateContact(contact.id(), newWorldContactKineRef, contact.contactWrenchVector_, false);
+          observer_->setStateContact(contact.id(), newWorldContactKineRef, contact.contactWrenchVector_, false);
         }
       }
 
@@ -604,22 +921,22 @@ bool MCKineticsObserver::run(const mc_control::MCController & ctl)
       newWorldCentroidKine.orientation = mcko_K_0_fb.orientation;
       newWorldCentroidKine.angVel = mcko_K_0_fb.angVel();
 
-      observer_.setWorldCentroidStateKinematics(newWorldCentroidKine, true);
-      observer_.setStateUnmodeledWrench(so::Vector6::Zero(), true);
+      observer_->setWorldCentroidStateKinematics(newWorldCentroidKine, true);
+      observer_->setStateUnmodeledWrench(so::Vector6::Zero(), true);
 
       for(size_t i = 0; i < listIMUs_.size(); ++i)
       {
         const auto & imu = listIMUs_[i];
 
-        observer_.setGyroBias(imu.gyroBias, static_cast<unsigned int>(i), true);
+        observer_->setGyroBias(imu.gyroBias, static_cast<unsigned int>(i), true);
       }
 
-      for(auto & [_, contact] : contactsManager_.contacts())
+      for(auto & contact : contactsManager_.contacts())
       {
         if(!contact.isSet()) { continue; }
 
         // Update of the force measurements (the offset due to the gravity changed)
-        const mc_rbdyn::ForceSensor & forceSensor = inputRobot.forceSensor(contact.forceSensor());
+        const mc_rbdyn::ForceSensor & forceSensor = inputRobot.forceSensors()[contact.forceSensorIndex()];
 
         if(contactsManager_.getContactsDetection() == KoContactsManager::ContactsDetection::Sensors)
         {
@@ -640,61 +957,44 @@ bool MCKineticsObserver::run(const mc_control::MCController & ctl)
         }
         else // we don't perform odometry, the reference pose of the contact is its pose in the control robot
         {
-          newWorldContactKineRef = getContactWorldKinematics(contact, robot, forceSensor);
+          getContactWorldKinematics(contact, robot, forceSensor, newWorldContactKineRef);
         }
 
-        observer_.setStateContact(contact.id(), newWorldContactKineRef, contact.contactWrenchVector_, true);
+        observer_->setStateContact(contact.id(), newWorldContactKineRef, contact.contactWrenchVector_, true);
       }
 
       // this variable indicates that we entered the invincibility frame
       invincibilityIter_ = 1;
       lastBackupIter_ = int(logger.t() / ctl.timeStep);
 
-      observer_.nanDetected_ = false;
+      observer_->nanDetected_ = false;
+      nanSimulationRequested_ = false;
 
       break;
     }
   }
 
+  floatingBaseTimer.stop();
+
   if(withDebugLogs_)
   {
+    profiling::ScopedTimer timer(stageTimings(debugLogsStage));
     /* Update of the logged variables */
-    correctedMeasurements_ = observer_.getEKF().getSimulatedMeasurement(observer_.getEKF().getCurrentTime());
-    for(auto & contact : maintainedContacts_)
-    {
-      contact->viscoElasticWrenchAfterCorrection_ = observer_.getCurrentViscoElasticWrench(contact->id());
-    }
-
-    globalCentroidKinematics_ = observer_.getGlobalCentroidKinematics();
-
-    contactsPosAverageStateCov_.setZero();
-    for(unsigned i = 0; i < maxContacts_; i++)
-    {
-      if(observer_.getContactIsSetByNum(i))
-      {
-        contactsPosAverageStateCov_ += 1 / pow(double(observer_.getNumberOfSetContacts()), 2)
-                                       * (observer_.getStateCovarianceMat().block(
-                                           observer_.contactIndexTangent(i), observer_.contactIndexTangent(i), 3, 3));
-
-        for(unsigned j = 0; j < maxContacts_; j++)
-        {
-          if(i != j && observer_.getContactIsSetByNum(j))
-          {
-            contactsPosAverageStateCov_ +=
-                1 / pow(double(observer_.getNumberOfSetContacts()), 2)
-                * (observer_.getStateCovarianceMat().block(observer_.contactIndexTangent(i),
-                                                           observer_.contactIndexTangent(j), 3, 3));
-          }
-        }
-      }
-    }
+    // the other debug variables are computed only if they are read, see correctedMeasurements(),
+    // viscoElasticWrenchAfterCorrection() and contactsPosAverageStateCov()
+    globalCentroidKinematics_ = observer_->getGlobalCentroidKinematics();
   }
 
+  // the worker thread updates the Kinetics Observer with the inputs of this iteration while the controller runs
+  if(asyncUpdate) { updateWorker_->trigger(); }
+
+#ifndef MC_STATE_OBSERVATION_HEADLESS
   /* Update of the visual representation (only a visual feature) of the observed robot */
   my_robots_->robot().mbc().q = ctl.realRobot().mbc().q;
 
   /* Update of the observed robot */
   update(my_robots_->robot());
+#endif
 
   return true;
 } // namespace mc_state_observation
@@ -708,15 +1008,15 @@ void MCKineticsObserver::initObserverStateVector(const mc_control::MCController
   so::kine::Orientation initOrientation(so::Matrix3(ctl.realRobot(robot_).posW().rotation().transpose()));
 
   Eigen::VectorXd initStateVector;
-  initStateVector = Eigen::VectorXd::Zero(observer_.getStateSize());
+  initStateVector = Eigen::VectorXd::Zero(observer_->getStateSize());
 
-  initStateVector.segment(observer_.posIndex(), observer_.sizePos) =
+  initStateVector.segment(observer_->posIndex(), observer_->sizePos) =
       initOrientation.toMatrix3().transpose() * robot.com();
-  initStateVector.segment(observer_.oriIndex(), observer_.sizeOri) = initOrientation.toVector4();
-  initStateVector.segment(observer_.linVelIndex(), observer_.sizeLinVel) =
+  initStateVector.segment(observer_->oriIndex(), observer_->sizeOri) = initOrientation.toVector4();
+  initStateVector.segment(observer_->linVelIndex(), observer_->sizeLinVel) =
       initOrientation.toMatrix3().transpose() * robot.comVelocity();
 
-  observer_.setInitWorldCentroidStateVector(initStateVector);
+  observer_->setInitWorldCentroidStateVector(initStateVector);
 }
 
 void MCKineticsObserver::update(mc_control::MCController & ctl) // this function is called by the pipeline if the
@@ -735,31 +1035,190 @@ void MCKineticsObserver::update(mc_rbdyn::Robot & robot)
   robot.velW(v_fb_0_.vector());
 }
 
+void MCKineticsObserver::updateEstimation()
+{
+  profiling::ScopedTimer timer(stageTimings(ekfUpdateStage));
+  KoUpdateResults & results = updateResults_.back();
+  const auto start = profiling::ScopedTimer::Clock::now();
+
+  const so::Vector * stateVector = nullptr;
+  {
+    // the allocations made by the estimator of the state-observation library are not under our control
+    profiling::allocations::ExternalCodeScope externalCode;
+    stateVector = &observer_->update();
+  }
+  // the results are preallocated, copying the state vector into them must not allocate
+  results.stateVector = *stateVector;
+  // the diagonal of the state covariance is read in place, and only by the debug logs
+  if(withDebugLogs_) { results.stateCovarianceDiagonal = observer_->getStateCovarianceMat().diagonal(); }
+
+  results.nanDetected = observer_->nanDetected_;
+  if(!results.nanDetected)
+  {
+    so::kine::Kinematics fbFb; // "Zero" Kinematics
+    fbFb.setZero<so::Matrix3>(so::kine::Kinematics::Flags::all);
+
+    // Given, the Kinematics of the floating base inside its own frame (zero kinematics) which is our user
+    // frame, the Kinetics Observer will return the kinematics of the floating base in the real world frame.
+    results.worldFbKine = observer_->getGlobalKinematicsOf(fbFb);
+  }
+  results.updateDuration = std::chrono::duration<double>(profiling::ScopedTimer::Clock::now() - start).count();
+
+  updateResults_.publish();
+}
+
+void MCKineticsObserver::compensateLatency(so::kine::Kinematics & worldFbKine, double dt)
+{
+  worldFbKine.position = so::Vector3(worldFbKine.position() + worldFbKine.linVel() * dt
+                                     + 0.5 * worldFbKine.linAcc() * dt * dt);
+  worldFbKine.orientation = so::Matrix3(
+      so::kine::rotationVectorToRotationMatrix(worldFbKine.angVel() * dt + 0.5 * worldFbKine.angAcc() * dt * dt)
+      * worldFbKine.orientation.toMatrix3());
+  worldFbKine.linVel = so::Vector3(worldFbKine.linVel() + worldFbKine.linAcc() * dt);
+  worldFbKine.angVel = so::Vector3(worldFbKine.angVel() + worldFbKine.angAcc() * dt);
+}
+
+void MCKineticsObserver::inputDelayedPoseMeasurement(const mc_control::MCController & ctl)
+{
+  delayedPoseMeas_.pending = false;
+
+  // the history of the estimation is not reliable while the Kinetics Observer recovers from a reset
+  if(runIter_ <= 1 || estimationState_ != noIssue) { return; }
+  if(delayedPoseMeas_.delay > koBackupFbKinematics_.size())
+  {
+    mc_rtc::log::warning("[{}]: The absolute pose measurement is older than the history of the estimation ({} "
+                         "iterations), it is ignored.",
+                         name(), koBackupFbKinematics_.size());
+    return;
+  }
+
+  // pose of the floating base on the current iteration, predicted from the last estimation
+  so::kine::Kinematics predictedWorldFbKine = updateResults_.front().worldFbKine;
+  compensateLatency(predictedWorldFbKine, ctl.timeStep * static_cast<double>(runIter_ - lastUpdateIter_));
+  so::kine::Kinematics worldFbPose;
+  worldFbPose.position = predictedWorldFbKine.position();
+  worldFbPose.orientation = predictedWorldFbKine.orientation;
+
+  so::kine::Kinematics measuredWorldFbPose = delayedPoseMeas_.worldFbKine;
+  if(delayedPoseMeas_.delay > 0)
+  {
+    // estimated pose of the floating base on the iteration of the measurement. The last entry of the history is the
+    // one of the previous iteration.
+    const so::kine::Kinematics worldFbPoseAtMeas =
+        koBackupFbKinematics_.at(koBackupFbKinematics_.size() - delayedPoseMeas_.delay);
+    // we transport the measurement to the current iteration with the displacement estimated in the meantime
+    measuredWorldFbPose = measuredWorldFbPose * (worldFbPoseAtMeas.getInverse() * worldFbPose);
+  }
+
+  so::Matrix6 covariance = so::Matrix6::Zero();
+  covariance.block<3, 3>(0, 0) = positionSensorCovariance_;
+  covariance.block<3, 3>(3, 3) = orientationSensorCoVariance_;
+  if(!delayedPoseMeas_.withPosition)
+  {
+    // the position is not measured, we give the estimated one with a covariance large enough to ignore it
+    measuredWorldFbPose.position = worldFbPose.position();
+    covariance.block<3, 3>(0, 0) = so::Matrix3::Identity() * 1e10;
+  }
+
+  observer_->setAbsolutePoseSensor(measuredWorldFbPose, covariance);
+}
+
+so::kine::Kinematics MCKineticsObserver::propagateWithTiltObserver(double dt)
+{
+  so::kine::Kinematics mcko_K_0_fb = tiltObserver_.applyLastTransformation(koBackupFbKinematics_.back());
+  koBackupFbKinematics_.push_back(mcko_K_0_fb);
+
+  X_0_fb_.rotation() = mcko_K_0_fb.orientation.toMatrix3().transpose();
+  X_0_fb_.translation() = mcko_K_0_fb.position();
+
+  // the tilt observer doesn't estimate the acceleration so we get it by finite differences
+  a_fb_0_.angular() = (mcko_K_0_fb.angVel() - v_fb_0_.angular()) / dt;
+  a_fb_0_.linear() = (mcko_K_0_fb.linVel() - v_fb_0_.linear()) / dt;
+
+  v_fb_0_.angular() = mcko_K_0_fb.angVel();
+  v_fb_0_.linear() = mcko_K_0_fb.linVel();
+
+  return mcko_K_0_fb;
+}
+
+bool MCKineticsObserver::ekfUpdateExceedsBudget() const
+{
+  if(ekfTimeBudget_ <= 0.0 || runIter_ <= 1) { return false; }
+  if(updateWorker_) { return updateWorker_->busy(); }
+  return lastUpdateIter_ + ekfUpdatePeriod_ == runIter_ && updateResults_.front().updateDuration > ekfTimeBudget_;
+}
+
+const so::Vector & MCKineticsObserver::correctedMeasurements()
+{
+  if(correctedMeasurementsIter_ != runIter_)
+  {
+    correctedMeasurements_ = observer_->getEKF().getSimulatedMeasurement(observer_->getEKF().getCurrentTime());
+    correctedMeasurementsIter_ = runIter_;
+  }
+  return correctedMeasurements_;
+}
+
+const so::Vector6 & MCKineticsObserver::viscoElasticWrenchAfterCorrection(const KoContactWithSensor & contact)
+{
+  if(contact.viscoElasticWrenchIter_ != runIter_)
+  {
+    contact.viscoElasticWrenchAfterCorrection_ = observer_->getCurrentViscoElasticWrench(contact.id());
+    contact.viscoElasticWrenchIter_ = runIter_;
+  }
+  return contact.viscoElasticWrenchAfterCorrection_;
+}
+
+const so::Matrix3 & MCKineticsObserver::contactsPosAverageStateCov()
+{
+  if(contactsPosAverageStateCovIter_ == runIter_) { return contactsPosAverageStateCov_; }
+  contactsPosAverageStateCovIter_ = runIter_;
+
+  contactsPosAverageStateCov_.setZero();
+  const double nbSetContacts = double(observer_->getNumberOfSetContacts());
+  if(nbSetContacts == 0.0) { return contactsPosAverageStateCov_; }
+
+  // we retrieve the covariance matrix only once as all its blocks between set contacts are summed
+  const so::Matrix & stateCov = observer_->getStateCovarianceMat();
+  for(unsigned i = 0; i < maxContacts_; i++)
+  {
+    if(!observer_->getContactIsSetByNum(i)) { continue; }
+    for(unsigned j = 0; j < maxContacts_; j++)
+    {
+      if(observer_->getContactIsSetByNum(j))
+      {
+        contactsPosAverageStateCov_ +=
+            stateCov.block<3, 3>(observer_->contactIndexTangent(i), observer_->contactIndexTangent(j));
+      }
+    }
+  }
+  contactsPosAverageStateCov_ /= nbSetContacts * nbSetContacts;
+
+  return contactsPosAverageStateCov_;
+}
+
 void MCKineticsObserver::inputAdditionalWrench(const mc_rbdyn::Robot & inputRobot, const mc_rbdyn::Robot & measRobot)
 {
   additionalUserResultingForce_.setZero();
   additionalUserResultingMoment_.setZero();
 
-  for(auto & contactWithSensor : contactsManager_.contacts())
+  for(const KoContactWithSensor & contact : contactsManager_.contacts())
   {
-    const KoContactWithSensor & contact = contactWithSensor.second;
-    const std::string & fsName = contact.forceSensor();
-
     if(!contact.isSet()
        && contact.sensorEnabled_) // if the contact is not set but we use the force sensor measurements,
                                   // then we give the measured force as an input to the Kinetics Observer
     {
-      sva::ForceVecd measuredWrench = measRobot.forceSensor(fsName).worldWrenchWithoutGravity(inputRobot);
+      sva::ForceVecd measuredWrench =
+          measRobot.forceSensors()[contact.forceSensorIndex()].worldWrenchWithoutGravity(inputRobot);
       additionalUserResultingForce_ += measuredWrench.force();
       additionalUserResultingMoment_ += measuredWrench.moment();
     }
   }
   // we add the wrench measured by the sensors that are not associated to contacts
-  for(auto & forceSensor : measRobot.forceSensors())
+  for(size_t i = 0; i < measRobot.forceSensors().size(); ++i)
   {
-    if(!contactsManager_.contacts().count(forceSensor.name()))
+    if(!contactsManager_.forceSensorHasContact(i))
     {
-      sva::ForceVecd measuredWrench = forceSensor.worldWrenchWithoutGravity(inputRobot);
+      sva::ForceVecd measuredWrench = measRobot.forceSensors()[i].worldWrenchWithoutGravity(inputRobot);
       additionalUserResultingForce_ += measuredWrench.force();
       additionalUserResultingMoment_ += measuredWrench.moment();
     }
@@ -768,19 +1227,18 @@ void MCKineticsObserver::inputAdditionalWrench(const mc_rbdyn::Robot & inputRobo
   addSensorsAsInputs(inputRobot, measRobot, additionalUserResultingForce_, additionalUserResultingMoment_);
 
   // We pass this computed wrench as an input to the Kinetics Observer
-  observer_.setAdditionalWrench(additionalUserResultingForce_, additionalUserResultingMoment_);
+  observer_->setAdditionalWrench(additionalUserResultingForce_, additionalUserResultingMoment_);
 
   if(withDebugLogs_)
   {
-    for(auto & contactWithSensor : contactsManager_.contacts())
+    for(KoContactWithSensor & contact : contactsManager_.contacts())
     {
-      KoContactWithSensor & contact = contactWithSensor.second;
-      const std::string & fsName = contact.forceSensor();
       so::Vector3 forceCentroid = so::Vector3::Zero();
       so::Vector3 torqueCentroid = so::Vector3::Zero();
-      observer_.convertWrenchFromUserToCentroid(
-          measRobot.forceSensor(fsName).worldWrenchWithoutGravity(inputRobot).force(),
-          measRobot.forceSensor(fsName).worldWrenchWithoutGravity(inputRobot).moment(), forceCentroid, torqueCentroid);
+      const sva::ForceVecd measuredWrench =
+          measRobot.forceSensors()[contact.forceSensorIndex()].worldWrenchWithoutGravity(inputRobot);
+      observer_->convertWrenchFromUserToCentroid(measuredWrench.force(), measuredWrench.moment(), forceCentroid,
+                                                 torqueCentroid);
 
       contact.wrenchInCentroid_.segment<3>(0) = forceCentroid;
       contact.wrenchInCentroid_.segment<3>(3) = torqueCentroid;
@@ -807,15 +1265,16 @@ void MCKineticsObserver::updateIMUs(const mc_rbdyn::Robot & measRobot, const mc_
     so::kine::Kinematics worldImuKine = worldBodyKine * bodyImuKine;
     listIMUs_.at(i).fbImuKine = worldImuKine;
 
-    observer_.setIMU(imu.linearAcceleration(), imu.angularVelocity(), acceleroSensorCovariance_, gyroSensorCovariance_,
-                     worldImuKine, i);
+    observer_->setIMU(imu.linearAcceleration(), imu.angularVelocity(), acceleroSensorCovariance_, gyroSensorCovariance_,
+                      worldImuKine, i);
   }
 }
 
-const so::kine::Kinematics MCKineticsObserver::getContactWorldKinematics(const KoContactWithSensor & contact,
-                                                                         const mc_rbdyn::Robot & currentRobot,
-                                                                         const mc_rbdyn::ForceSensor & fs,
-                                                                         const sva::ForceVecd * measuredWrench)
+void MCKineticsObserver::getContactWorldKinematics(const KoContactWithSensor & contact,
+                                                   const mc_rbdyn::Robot & currentRobot,
+                                                   const mc_rbdyn::ForceSensor & fs,
+                                                   so::kine::Kinematics & worldContactKine,
+                                                   const sva::ForceVecd * measuredWrench)
 {
   /*
   Can be used with inputRobot, a virtual robot corresponding to the real robot whose floating base's frame is
@@ -825,8 +1284,6 @@ const so::kine::Kinematics MCKineticsObserver::getContactWorldKinematics(const K
   and not do the conversion: initial frame -> world + world -> floating base as the latter is zero.
   */
 
-  so::kine::Kinematics worldContactKine;
-
   const sva::PTransformd & bodyContactSensorPose = fs.X_p_f();
   so::kine::Kinematics bodyContactSensorKine =
       conversions::kinematics::fromSva(bodyContactSensorPose, so::kine::Kinematics::Flags::vel);
@@ -876,8 +1333,6 @@ const so::kine::Kinematics MCKineticsObserver::getContactWorldKinematics(const K
       updateContactForceMeasurement(nc_contact, *measuredWrench, &contact.contactSensorKine_);
     }
   }
-
-  return worldContactKine;
 }
 
 void MCKineticsObserver::updateContactForceMeasurement(KoContactWithSensor & contact,
@@ -902,11 +1357,10 @@ void MCKineticsObserver::updateContactForceMeasurement(KoContactWithSensor & con
   }
 }
 
-void MCKineticsObserver::getOdometryWorldContactRest(const mc_control::MCController & ctl,
+void MCKineticsObserver::getOdometryWorldContactRest(const mc_control::MCController &,
                                                      KoContactWithSensor & contact,
                                                      so::kine::Kinematics & worldContactKineRef)
 {
-  const auto & robot = ctl.robot(robot_);
   if(!contact.sensorEnabled_)
   {
     mc_rtc::log::info("The sensor is disabled but is required for the odometry. It will be used for the odometry "
@@ -919,7 +1373,7 @@ void MCKineticsObserver::getOdometryWorldContactRest(const mc_control::MCControl
   // we get the kinematics of the contact in the real world from the ones of the centroid estimated by the Kinetics
   // Observer. These kinematics are not the reference kinematics of the contact as they take into account the
   // visco-elastic model of the contacts.
-  const so::kine::Kinematics worldContactKine = observer_.getGlobalKinematicsOf(contact.fbContactKine_);
+  const so::kine::Kinematics worldContactKine = observer_->getGlobalKinematicsOf(contact.fbContactKine_);
 
   // we get the reference position of the contact by removing the contribution of the visco-elastic model
   worldContactKineRef.position =
@@ -955,11 +1409,7 @@ void MCKineticsObserver::getOdometryWorldContactRest(const mc_control::MCControl
      == measurements::OdometryType::Flat) // if true, the position odometry is made only along the x and y axis,
                                           // the position along z is assumed to be the one of the control robot
   {
-    // kinematics of the contact of the control robot in the world frame
-    so::kine::Kinematics worldContactKineControl =
-        getContactWorldKinematics(contact, robot, robot.forceSensor(contact.forceSensor()));
-
-    // the reference altitude of the contact is the one in the control robot
+    // the reference altitude of the contact is the one of the ground
     worldContactKineRef.position()(2) = 0.0;
   }
 }
@@ -980,12 +1430,12 @@ void MCKineticsObserver::setNewContact(const mc_control::MCController & ctl,
 
   const auto & robot = ctl.robot(robot_);
 
-  sva::ForceVecd measuredWrench = robot.forceSensor(contact.forceSensor()).wrenchWithoutGravity(inputRobot);
-  const mc_rbdyn::ForceSensor & forceSensor = robot.forceSensor(contact.forceSensor());
+  const mc_rbdyn::ForceSensor & forceSensor = robot.forceSensors()[contact.forceSensorIndex()];
+  sva::ForceVecd measuredWrench = forceSensor.wrenchWithoutGravity(inputRobot);
 
   // As used on input robot, returns the kinematics of the contact in the frame of the floating base. Also expresses the
   // measured wrench in the frame of the contact.
-  contact.fbContactKine_ = getContactWorldKinematics(contact, inputRobot, forceSensor, &measuredWrench);
+  getContactWorldKinematics(contact, inputRobot, forceSensor, contact.fbContactKine_, &measuredWrench);
 
   // reference of the contact in the world / floating base of the input robot
   so::kine::Kinematics worldContactKineRef;
@@ -993,31 +1443,34 @@ void MCKineticsObserver::setNewContact(const mc_control::MCController & ctl,
   if(odometryType_ != measurements::OdometryType::None) // the Kinetics Observer performs odometry. The estimated
                                                         // state is used to provide the new contacts references.
   {
-    getOdometryWorldContactRest(ctl, contact, worldContactKineRef);
+    // on the first iteration after a warm start, the contacts keep the references they had in the previous run
+    auto restoredRef = restoredContactRefs_.find(contact.name());
+    if(restoredRef != restoredContactRefs_.end()) { worldContactKineRef = restoredRef->second; }
+    else { getOdometryWorldContactRest(ctl, contact, worldContactKineRef); }
   }
   else // we don't perform odometry, the reference pose of the contact is its pose in the control robot
   {
-    worldContactKineRef = getContactWorldKinematics(contact, robot, forceSensor);
+    getContactWorldKinematics(contact, robot, forceSensor, worldContactKineRef);
   }
 
-  observer_.addContact(worldContactKineRef, initCovariance, contactProcessCovariance_, contact.id(), linStiffness_,
-                       linDamping_, angStiffness_, angDamping_);
+  observer_->addContact(worldContactKineRef, initCovariance, contactProcessCovariance_, contact.id(), linStiffness_,
+                        linDamping_, angStiffness_, angDamping_);
 
   // checks if the sensor is used in the correction of the Kinetics Observer or not
   if(contact.sensorEnabled_)
   {
     // we update the measurements of the sensor and the input kinematics of the contact in the user /
     // floating base's frame
-    observer_.updateContactWithWrenchSensor(contact.contactWrenchVector_, contactSensorCovariance_,
-                                            contact.fbContactKine_, contact.id());
+    observer_->updateContactWithWrenchSensor(contact.contactWrenchVector_, contactSensorCovariance_,
+                                             contact.fbContactKine_, contact.id());
   }
   else
   {
     // we update the input kinematics of the contact in the user / floating base's frame
-    observer_.updateContactWithNoSensor(contact.fbContactKine_, contact.id());
+    observer_->updateContactWithNoSensor(contact.fbContactKine_, contact.id());
   }
 
-  if(withDebugLogs_)
+  if(withDebugLogs_ && !withPreRegisteredContactLogs_)
   {
     addContactLogEntries(ctl, logger, contact);
     if(contact.sensorEnabled_) { addContactMeasurementsLogEntries(logger, contact); }
@@ -1037,28 +1490,30 @@ void MCKineticsObserver::updateContact(const mc_control::MCController & ctl, KoC
 
   const auto & robot = ctl.robot(robot_);
 
-  sva::ForceVecd measuredWrench = robot.forceSensor(contact.forceSensor()).wrenchWithoutGravity(inputRobot);
-  const mc_rbdyn::ForceSensor & forceSensor = robot.forceSensor(contact.forceSensor());
+  const mc_rbdyn::ForceSensor & forceSensor = robot.forceSensors()[contact.forceSensorIndex()];
+  sva::ForceVecd measuredWrench = forceSensor.wrenchWithoutGravity(inputRobot);
 
   // As used on input robot, returns the kinematics of the contact in the frame of the floating base. Also expresses the
   // measured wrench in the frame of the contact.
-  contact.fbContactKine_ = getContactWorldKinematics(contact, inputRobot, forceSensor, &measuredWrench);
+  getContactWorldKinematics(contact, inputRobot, forceSensor, contact.fbContactKine_, &measuredWrench);
 
   if(contact.sensorEnabled_) // the force sensor attached to the contact is used in the correction by the
                              // Kinetics Observer.
   {
-    observer_.updateContactWithWrenchSensor(contact.contactWrenchVector_, contactSensorCovariance_,
-                                            contact.fbContactKine_, contact.id());
+    observer_->updateContactWithWrenchSensor(contact.contactWrenchVector_, contactSensorCovariance_,
+                                             contact.fbContactKine_, contact.id());
   }
-  else { observer_.updateContactWithNoSensor(contact.fbContactKine_, contact.id()); }
+  else { observer_->updateContactWithNoSensor(contact.fbContactKine_, contact.id()); }
 }
 
-void MCKineticsObserver::updateContacts(const mc_control::MCController & ctl, mc_rtc::Logger & logger)
+void MCKineticsObserver::updateContacts(const mc_control::MCController & ctl,
+                                        mc_rtc::Logger & logger,
+                                        double samplingTime)
 {
   const so::Matrix12 * initCovariance;
 
-  if(observer_.getNumberOfSetContacts() > 0) // The initial covariance on the pose of the contact depending on
-                                             // whether another contact is already set or not
+  if(observer_->getNumberOfSetContacts() > 0) // The initial covariance on the pose of the contact depending on
+                                              // whether another contact is already set or not
   {
     if(odometryType_ == measurements::OdometryType::Flat)
     {
@@ -1088,9 +1543,9 @@ void MCKineticsObserver::updateContacts(const mc_control::MCController & ctl, mc
   { updateContact(ctl, maintainedContact); };
   auto onRemovedContact = [this, &logger](KoContactWithSensor & removedContact)
   {
-    observer_.removeContact(removedContact.id());
+    observer_->removeContact(removedContact.id());
 
-    if(withDebugLogs_)
+    if(withDebugLogs_ && !withPreRegisteredContactLogs_)
     {
       removeContactLogEntries(logger, removedContact);
       removeContactMeasurementsLogEntries(logger, removedContact);
@@ -1100,15 +1555,32 @@ void MCKineticsObserver::updateContacts(const mc_control::MCController & ctl, mc
   // action to execute when a contact is added to the manager during the run, which happens when the contact detection
   // is using the solver.
   auto onAddedContact = [this, &ctl, &logger](KoContactWithSensor & addedContact)
-  { addContactToGui(ctl, addedContact, logger); };
+  {
+    // the id of the contact is its index in the state vector
+    if(addedContact.id() >= maxContacts_)
+    {
+      mc_rtc::log::error_and_throw<std::runtime_error>(
+          "[{}] The contact {} was detected but the maximum amount of contacts ({}) is reached, please increase "
+          "maxContacts.",
+          name(), addedContact.name(), maxContacts_);
+    }
+    addContactToGui(ctl, addedContact, logger);
+    if(withDebugLogs_ && withPreRegisteredContactLogs_)
+    {
+      addPreRegisteredContactLogEntries(ctl, logger, addedContact);
+    }
+  };
 
-  contactsManager_.updateContacts(ctl, robot_, onNewContact, onMaintainedContact, onRemovedContact, onAddedContact);
+  contactsManager_.updateContacts(ctl, robot_, onNewContact, onMaintainedContact, onRemovedContact, onAddedContact,
+                                  samplingTime);
+  // the restored references are valid only for the contacts already set when the observer was stopped
+  if(!restoredContactRefs_.empty()) { restoredContactRefs_.clear(); }
 }
 
 void MCKineticsObserver::mass(double mass)
 {
   mass_ = mass;
-  observer_.setMass(mass);
+  observer_->setMass(mass);
 }
 
 ///////////////////////////////////////////////////////////////////////
@@ -1128,7 +1600,7 @@ void MCKineticsObserver::addToLogger(const mc_control::MCController & ctl,
   logger.addLogEntry(category_ + "_mcko_fb_yaw",
                      [this]() -> double { return -so::kine::rotationMatrixToYawAxisAgnostic(X_0_fb_.rotation()); });
 
-  logger.addLogEntry(category_ + "_constants_mass", [this]() -> double { return observer_.getMass(); });
+  logger.addLogEntry(category_ + "_constants_mass", [this]() -> double { return observer_->getMass(); });
 
   logger.addLogEntry(category_ + "_debug_estimationState",
                      [this]() -> std::string
@@ -1150,26 +1622,53 @@ void MCKineticsObserver::addToLogger(const mc_control::MCController & ctl,
   logger.addLogEntry(category_ + "_debug_config_OdometryType",
                      [this]() -> std::string { return measurements::odometryTypeToSstring(odometryType_); });
 
+  if(withStageTimings_)
+  {
+    for(size_t i = 0; i < nbRunStages; ++i)
+    {
+      const std::string entryName = category_ + "_timings_" + runStagesNames_[i];
+      const profiling::LatencyHistogram & histogram = runStageTimings_[i];
+      logger.addLogEntry(entryName + "_min", [&histogram]() -> double { return histogram.min(); });
+      logger.addLogEntry(entryName + "_mean", [&histogram]() -> double { return histogram.mean(); });
+      logger.addLogEntry(entryName + "_p99", [&histogram]() -> double { return histogram.percentile(0.99); });
+      logger.addLogEntry(entryName + "_max", [&histogram]() -> double { return histogram.max(); });
+    }
+  }
+
   logger.addLogEntry(category_ + "_debug_config_withAdaptativeContactProcessCov", [this]() -> std::string
-                     { return observer_.getWithAdaptativeContactProcessCov() ? "True" : "False"; });
+                     { return observer_->getWithAdaptativeContactProcessCov() ? "True" : "False"; });
+
+  // the contacts added to the manager later during the run are registered on their addition. The contacts that don't
+  // fit in the state vector of the Kinetics Observer are never set, so they are not registered.
+  if(withDebugLogs_ && withPreRegisteredContactLogs_)
+  {
+    for(const auto & contact : contactsManager_.contacts())
+    {
+      if(contact.id() >= maxContacts_) { continue; }
+      addPreRegisteredContactLogEntries(ctl, logger, contact);
+    }
+  }
 
   /* Plots of the updated state */
+  // the state is read from the results of the update as the Kinetics Observer can be running on the worker thread
   conversions::kinematics::addToLogger(logger, globalCentroidKinematics_, category_ + "_MEKF_estimatedState");
   for(auto & imu : listIMUs_)
   {
     logger.addLogEntry(category_ + "_MEKF_estimatedState_gyroBias_" + imu.name(),
                        [this, &imu]() -> Eigen::Vector3d {
-                         return observer_.getCurrentStateVector().segment(observer_.gyroBiasIndex(imu.id()),
-                                                                          observer_.sizeGyroBias);
+                         return updateResults_.front().stateVector.segment(observer_->gyroBiasIndex(imu.id()),
+                                                                           observer_->sizeGyroBias);
                        });
   }
   logger.addLogEntry(
       category_ + "_MEKF_estimatedState_extForceCentr", [this]() -> Eigen::Vector3d
-      { return observer_.getCurrentStateVector().segment(observer_.unmodeledForceIndex(), observer_.sizeForce); });
+      { return updateResults_.front().stateVector.segment(observer_->unmodeledForceIndex(), observer_->sizeForce); });
 
   logger.addLogEntry(
       category_ + "_MEKF_estimatedState_extTorqueCentr", [this]() -> Eigen::Vector3d
-      { return observer_.getCurrentStateVector().segment(observer_.unmodeledTorqueIndex(), observer_.sizeTorque); });
+      { return updateResults_.front().stateVector.segment(observer_->unmodeledTorqueIndex(), observer_->sizeTorque); });
+  logger.addLogEntry(category_ + "_mcko_estimationLatency", [this]() -> double { return estimationLatency_; });
+  logger.addLogEntry(category_ + "_mcko_degradedIterations", [this]() -> uint64_t { return degradedIters_; });
   if(withDebugLogs_)
   {
     for(auto & imu : listIMUs_)
@@ -1177,71 +1676,69 @@ void MCKineticsObserver::addToLogger(const mc_control::MCController & ctl,
       logger.addLogEntry(category_ + "_MEKF_stateCovariances_gyroBias_" + imu.name(),
                          [this, &imu]() -> Eigen::Vector3d
                          {
-                           return observer_.getEKF()
-                               .getStateCovariance()
-                               .block(observer_.gyroBiasIndexTangent(imu.id()),
-                                      observer_.gyroBiasIndexTangent(imu.id()), observer_.sizeGyroBiasTangent,
-                                      observer_.sizeGyroBiasTangent)
-                               .diagonal();
+                           return stateCovarianceDiagonal().segment(observer_->gyroBiasIndexTangent(imu.id()),
+                                                                   observer_->sizeGyroBiasTangent);
                          });
       logger.addLogEntry(
           category_ + "_MEKF_measurements_predError_vector", [this]() -> Eigen::VectorXd
-          { return (observer_.getEKF().getLastMeasurement() - observer_.getEKF().getLastPredictedMeasurement()); });
+          { return (observer_->getEKF().getLastMeasurement() - observer_->getEKF().getLastPredictedMeasurement()); });
       logger.addLogEntry(
           category_ + "_MEKF_measurements_predError_norm",
-          [this]() -> double {
-            return (observer_.getEKF().getLastMeasurement() - observer_.getEKF().getLastPredictedMeasurement()).norm();
+          [this]() -> double
+          {
+            const auto & ekf = observer_->getEKF();
+            return (ekf.getLastMeasurement() - ekf.getLastPredictedMeasurement()).norm();
           });
       logger.addLogEntry(category_ + "_MEKF_measurements_gyro_" + imu.name() + "_measured",
                          [this, &imu]() -> Eigen::Vector3d
                          {
-                           return observer_.getEKF().getLastMeasurement().segment(
-                               observer_.getIMUMeasIndexByNum(imu.id()) + observer_.sizeAcceleroSignal,
-                               observer_.sizeGyroBias);
+                           return observer_->getEKF().getLastMeasurement().segment(
+                               observer_->getIMUMeasIndexByNum(imu.id()) + observer_->sizeAcceleroSignal,
+                               observer_->sizeGyroBias);
                          });
       logger.addLogEntry(category_ + "_MEKF_measurements_gyro_" + imu.name() + "_predicted",
                          [this, &imu]() -> Eigen::Vector3d
                          {
-                           return observer_.getEKF().getLastPredictedMeasurement().segment(
-                               observer_.getIMUMeasIndexByNum(imu.id()) + observer_.sizeAcceleroSignal,
-                               observer_.sizeGyroBias);
+                           return observer_->getEKF().getLastPredictedMeasurement().segment(
+                               observer_->getIMUMeasIndexByNum(imu.id()) + observer_->sizeAcceleroSignal,
+                               observer_->sizeGyroBias);
                          });
       logger.addLogEntry(category_ + "_MEKF_measurements_gyro_" + imu.name() + "_corrected",
                          [this, &imu]() -> Eigen::Vector3d
                          {
-                           return correctedMeasurements_.segment(observer_.getIMUMeasIndexByNum(imu.id())
-                                                                     + observer_.sizeAcceleroSignal,
-                                                                 observer_.sizeGyroBias);
+                           return correctedMeasurements().segment(observer_->getIMUMeasIndexByNum(imu.id())
+                                                                     + observer_->sizeAcceleroSignal,
+                                                                 observer_->sizeGyroBias);
                          });
 
       logger.addLogEntry(category_ + "_MEKF_measurements_accelerometer_" + imu.name() + "_measured",
                          [this, &imu]() -> Eigen::Vector3d
                          {
-                           return observer_.getEKF().getLastMeasurement().segment(
-                               observer_.getIMUMeasIndexByNum(imu.id()), observer_.sizeAcceleroSignal);
+                           return observer_->getEKF().getLastMeasurement().segment(
+                               observer_->getIMUMeasIndexByNum(imu.id()), observer_->sizeAcceleroSignal);
                          });
       logger.addLogEntry(category_ + "_MEKF_measurements_accelerometer_" + imu.name() + "_predicted",
                          [this, &imu]() -> Eigen::Vector3d
                          {
-                           return observer_.getEKF().getLastPredictedMeasurement().segment(
-                               observer_.getIMUMeasIndexByNum(imu.id()), observer_.sizeAcceleroSignal);
+                           return observer_->getEKF().getLastPredictedMeasurement().segment(
+                               observer_->getIMUMeasIndexByNum(imu.id()), observer_->sizeAcceleroSignal);
                          });
       logger.addLogEntry(category_ + "_MEKF_measurements_accelerometer_" + imu.name() + "_corrected",
                          [this, &imu]() -> Eigen::Vector3d {
-                           return correctedMeasurements_.segment(observer_.getIMUMeasIndexByNum(imu.id()),
-                                                                 observer_.sizeAcceleroSignal);
+                           return correctedMeasurements().segment(observer_->getIMUMeasIndexByNum(imu.id()),
+                                                                 observer_->sizeAcceleroSignal);
                          });
       logger.addLogEntry(category_ + "_MEKF_innovation_gyroBias_" + imu.name(),
                          [this, &imu]() -> Eigen::Vector3d
                          {
-                           return observer_.getEKF().getInnovation().segment(observer_.gyroBiasIndexTangent(imu.id()),
-                                                                             observer_.sizeGyroBiasTangent);
+                           return observer_->getEKF().getInnovation().segment(observer_->gyroBiasIndexTangent(imu.id()),
+                                                                              observer_->sizeGyroBiasTangent);
                          });
       logger.addLogEntry(category_ + "_MEKF_prediction_gyroBias_" + imu.name(),
                          [this, &imu]() -> Eigen::Vector3d
                          {
-                           return observer_.getEKF().getLastPrediction().segment(
-                               observer_.gyroBiasIndexTangent(imu.id()), observer_.sizeGyroBias);
+                           return observer_->getEKF().getLastPrediction().segment(
+                               observer_->gyroBiasIndexTangent(imu.id()), observer_->sizeGyroBias);
                          });
       logger.addLogEntry(category_ + "_debug_gyroBias_" + imu.name(),
                          [&imu]() -> Eigen::Vector3d { return imu.gyroBias; });
@@ -1251,72 +1748,56 @@ void MCKineticsObserver::addToLogger(const mc_control::MCController & ctl,
 
     /* Inputs */
     logger.addLogEntry(category_ + "_MEKF_inputs_additionalWrench_Force", [this]() -> Eigen::Vector3d
-                       { return observer_.getAdditionalWrench().segment(0, observer_.sizeForce); });
+                       { return observer_->getAdditionalWrench().segment(0, observer_->sizeForce); });
     logger.addLogEntry(category_ + "_MEKF_inputs_additionalWrench_Torque", [this]() -> Eigen::Vector3d
-                       { return observer_.getAdditionalWrench().segment(observer_.sizeForce, observer_.sizeTorque); });
+                       {
+                         return observer_->getAdditionalWrench().segment(observer_->sizeForce, observer_->sizeTorque);
+                       });
 
     /* State covariances */
     logger.addLogEntry(category_ + "_MEKF_stateCovariances_contactsPosAverage_x",
-                       [this]() -> double { return contactsPosAverageStateCov_(0, 0); });
+                       [this]() -> double { return contactsPosAverageStateCov()(0, 0); });
     logger.addLogEntry(category_ + "_MEKF_stateCovariances_contactsPosAverage_y",
-                       [this]() -> double { return contactsPosAverageStateCov_(1, 1); });
+                       [this]() -> double { return contactsPosAverageStateCov()(1, 1); });
     logger.addLogEntry(category_ + "_MEKF_stateCovariances_contactsPosAverage_z",
-                       [this]() -> double { return contactsPosAverageStateCov_(2, 2); });
+                       [this]() -> double { return contactsPosAverageStateCov()(2, 2); });
 
     logger.addLogEntry(category_ + "_MEKF_stateCovariances_positionW_",
                        [this]() -> Eigen::Vector3d
                        {
-                         return observer_.getEKF()
-                             .getStateCovariance()
-                             .block(observer_.posIndexTangent(), observer_.posIndexTangent(), observer_.sizePosTangent,
-                                    observer_.sizePosTangent)
-                             .diagonal();
+                         return stateCovarianceDiagonal().segment(observer_->posIndexTangent(),
+                                                                  observer_->sizePosTangent);
                        });
     logger.addLogEntry(category_ + "_MEKF_stateCovariances_orientationW_",
                        [this]() -> Eigen::Vector3d
                        {
-                         return observer_.getEKF()
-                             .getStateCovariance()
-                             .block(observer_.oriIndexTangent(), observer_.oriIndexTangent(), observer_.sizeOriTangent,
-                                    observer_.sizeOriTangent)
-                             .diagonal();
+                         return stateCovarianceDiagonal().segment(observer_->oriIndexTangent(),
+                                                                  observer_->sizeOriTangent);
                        });
     logger.addLogEntry(category_ + "_MEKF_stateCovariances_linVelW_",
                        [this]() -> Eigen::Vector3d
                        {
-                         return observer_.getEKF()
-                             .getStateCovariance()
-                             .block(observer_.linVelIndexTangent(), observer_.linVelIndexTangent(),
-                                    observer_.sizeLinVelTangent, observer_.sizeLinVelTangent)
-                             .diagonal();
+                         return stateCovarianceDiagonal().segment(observer_->linVelIndexTangent(),
+                                                                 observer_->sizeLinVelTangent);
                        });
     logger.addLogEntry(category_ + "_MEKF_stateCovariances_angVelW_",
                        [this]() -> Eigen::Vector3d
                        {
-                         return observer_.getEKF()
-                             .getStateCovariance()
-                             .block(observer_.angVelIndexTangent(), observer_.angVelIndexTangent(),
-                                    observer_.sizeAngVelTangent, observer_.sizeAngVelTangent)
-                             .diagonal();
+                         return stateCovarianceDiagonal().segment(observer_->angVelIndexTangent(),
+                                                                 observer_->sizeAngVelTangent);
                        });
 
     logger.addLogEntry(category_ + "_MEKF_stateCovariances_extForce_",
                        [this]() -> Eigen::Vector3d
                        {
-                         return observer_.getEKF()
-                             .getStateCovariance()
-                             .block(observer_.unmodeledForceIndexTangent(), observer_.unmodeledForceIndexTangent(),
-                                    observer_.sizeForceTangent, observer_.sizeForceTangent)
-                             .diagonal();
+                         return stateCovarianceDiagonal().segment(observer_->unmodeledForceIndexTangent(),
+                                                                 observer_->sizeForceTangent);
                        });
     logger.addLogEntry(category_ + "_MEKF_stateCovariances_extTorque_",
                        [this]() -> Eigen::Vector3d
                        {
-                         return observer_.getEKF()
-                             .getStateCovariance()
-                             .block(observer_.unmodeledTorqueIndexTangent(), observer_.unmodeledTorqueIndexTangent(),
-                                    observer_.sizeTorqueTangent, observer_.sizeTorqueTangent)
-                             .diagonal();
+                         return stateCovarianceDiagonal().segment(observer_->unmodeledTorqueIndexTangent(),
+                                                                 observer_->sizeTorqueTangent);
                        });
 
     if(ctl.realRobot().hasBody("LeftFoot"))
@@ -1367,22 +1848,22 @@ void MCKineticsObserver::addToLogger(const mc_control::MCController & ctl,
     /* Plots of the inputs */
 
     logger.addLogEntry(category_ + "_MEKF_inputs_angularMomentum",
-                       [this]() -> Eigen::Vector3d { return observer_.getAngularMomentum()(); });
+                       [this]() -> Eigen::Vector3d { return observer_->getAngularMomentum()(); });
     logger.addLogEntry(category_ + "_MEKF_inputs_angularMomentumDot",
-                       [this]() -> Eigen::Vector3d { return observer_.getAngularMomentumDot()(); });
+                       [this]() -> Eigen::Vector3d { return observer_->getAngularMomentumDot()(); });
     logger.addLogEntry(category_ + "_MEKF_inputs_com",
-                       [this]() -> Eigen::Vector3d { return observer_.getCenterOfMass()(); });
+                       [this]() -> Eigen::Vector3d { return observer_->getCenterOfMass()(); });
     logger.addLogEntry(category_ + "_MEKF_inputs_comDot",
-                       [this]() -> Eigen::Vector3d { return observer_.getCenterOfMassDot()(); });
+                       [this]() -> Eigen::Vector3d { return observer_->getCenterOfMassDot()(); });
     logger.addLogEntry(category_ + "_MEKF_inputs_comDotDot",
-                       [this]() -> Eigen::Vector3d { return observer_.getCenterOfMassDotDot()(); });
+                       [this]() -> Eigen::Vector3d { return observer_->getCenterOfMassDotDot()(); });
     logger.addLogEntry(category_ + "_MEKF_inputs_inertiaMatrix",
                        [this]() -> Eigen::Vector6d
                        {
                          so::Vector6 inertia;
-                         inertia.segment<3>(0) = observer_.getInertiaMatrix()().diagonal();
-                         inertia.segment<2>(3) = observer_.getInertiaMatrix()().block<1, 2>(0, 1);
-                         inertia(5) = observer_.getInertiaMatrix()()(1, 2);
+                         inertia.segment<3>(0) = observer_->getInertiaMatrix()().diagonal();
+                         inertia.segment<2>(3) = observer_->getInertiaMatrix()().block<1, 2>(0, 1);
+                         inertia(5) = observer_->getInertiaMatrix()()(1, 2);
                          return inertia;
                        });
 
@@ -1390,9 +1871,9 @@ void MCKineticsObserver::addToLogger(const mc_control::MCController & ctl,
                        [this]() -> Eigen::Vector6d
                        {
                          so::Vector6 inertiaDot;
-                         inertiaDot.segment<3>(0) = observer_.getInertiaMatrixDot()().diagonal();
-                         inertiaDot.segment<2>(3) = observer_.getInertiaMatrixDot()().block<1, 2>(0, 1);
-                         inertiaDot(5) = observer_.getInertiaMatrixDot()()(1, 2);
+                         inertiaDot.segment<3>(0) = observer_->getInertiaMatrixDot()().diagonal();
+                         inertiaDot.segment<2>(3) = observer_->getInertiaMatrixDot()().block<1, 2>(0, 1);
+                         inertiaDot(5) = observer_->getInertiaMatrixDot()()(1, 2);
                          return inertiaDot;
                        });
 
@@ -1402,7 +1883,7 @@ void MCKineticsObserver::addToLogger(const mc_control::MCController & ctl,
                          [this]() -> Eigen::Quaterniond
                          {
                            so::kine::Orientation ori;
-                           ori.fromVector4(observer_.getEKF().getLastMeasurement().tail(4));
+                           ori.fromVector4(observer_->getEKF().getLastMeasurement().tail(4));
 
                            return ori.toQuaternion().inverse();
                          });
@@ -1410,7 +1891,7 @@ void MCKineticsObserver::addToLogger(const mc_control::MCController & ctl,
                          [this]() -> Eigen::Quaterniond
                          {
                            so::kine::Orientation ori;
-                           ori.fromVector4(correctedMeasurements_.tail(4));
+                           ori.fromVector4(correctedMeasurements().tail(4));
 
                            return ori.toQuaternion().inverse();
                          });
@@ -1418,7 +1899,7 @@ void MCKineticsObserver::addToLogger(const mc_control::MCController & ctl,
                          [this]() -> Eigen::Quaterniond
                          {
                            so::kine::Orientation ori;
-                           ori.fromVector4(observer_.getEKF().getLastPredictedMeasurement().tail(4));
+                           ori.fromVector4(observer_->getEKF().getLastPredictedMeasurement().tail(4));
 
                            return ori.toQuaternion().inverse();
                          });
@@ -1427,31 +1908,35 @@ void MCKineticsObserver::addToLogger(const mc_control::MCController & ctl,
     /* Plots of the innovation */
     logger.addLogEntry(
         category_ + "_MEKF_innovation_positionW_", [this]() -> Eigen::Vector3d
-        { return observer_.getEKF().getInnovation().segment(observer_.posIndexTangent(), observer_.sizePosTangent); });
+        {
+          return observer_->getEKF().getInnovation().segment(observer_->posIndexTangent(), observer_->sizePosTangent);
+        });
     logger.addLogEntry(category_ + "_MEKF_innovation_linVelW_",
                        [this]() -> Eigen::Vector3d {
-                         return observer_.getEKF().getInnovation().segment(observer_.linVelIndexTangent(),
-                                                                           observer_.sizeLinVelTangent);
+                         return observer_->getEKF().getInnovation().segment(observer_->linVelIndexTangent(),
+                                                                            observer_->sizeLinVelTangent);
                        });
     logger.addLogEntry(
         category_ + "_MEKF_innovation_oriW_", [this]() -> Eigen::Vector3d
-        { return observer_.getEKF().getInnovation().segment(observer_.oriIndexTangent(), observer_.sizeOriTangent); });
+        {
+          return observer_->getEKF().getInnovation().segment(observer_->oriIndexTangent(), observer_->sizeOriTangent);
+        });
     logger.addLogEntry(category_ + "_MEKF_innovation_angVelW_",
                        [this]() -> Eigen::Vector3d {
-                         return observer_.getEKF().getInnovation().segment(observer_.angVelIndexTangent(),
-                                                                           observer_.sizeAngVelTangent);
+                         return observer_->getEKF().getInnovation().segment(observer_->angVelIndexTangent(),
+                                                                            observer_->sizeAngVelTangent);
                        });
     logger.addLogEntry(category_ + "_MEKF_innovation_unmodeledForce_",
                        [this]() -> Eigen::Vector3d
                        {
-                         return observer_.getEKF().getInnovation().segment(observer_.unmodeledForceIndexTangent(),
-                                                                           observer_.sizeForceTangent);
+                         return observer_->getEKF().getInnovation().segment(observer_->unmodeledForceIndexTangent(),
+                                                                            observer_->sizeForceTangent);
                        });
     logger.addLogEntry(category_ + "_MEKF_innovation_unmodeledTorque_",
                        [this]() -> Eigen::Vector3d
                        {
-                         return observer_.getEKF().getInnovation().segment(observer_.unmodeledTorqueIndexTangent(),
-                                                                           observer_.sizeTorqueTangent);
+                         return observer_->getEKF().getInnovation().segment(observer_->unmodeledTorqueIndexTangent(),
+                                                                            observer_->sizeTorqueTangent);
                        });
 
     /* Plots of the prediction */
@@ -1459,8 +1944,8 @@ void MCKineticsObserver::addToLogger(const mc_control::MCController & ctl,
                        [this]() -> Eigen::Vector3d
                        {
                          so::kine::LocalKinematics predictedWorldCentroidLocKine(
-                             observer_.getEKF().getLastPrediction().segment(observer_.posIndex(),
-                                                                            observer_.sizePos + observer_.sizeOri),
+                             observer_->getEKF().getLastPrediction().segment(observer_->posIndex(),
+                                                                             observer_->sizePos + observer_->sizeOri),
                              so::kine::Kinematics::Flags::pose);
                          so::kine::Kinematics predictedWorlCentroidKine(predictedWorldCentroidLocKine);
                          return predictedWorlCentroidKine.position();
@@ -1472,8 +1957,8 @@ void MCKineticsObserver::addToLogger(const mc_control::MCController & ctl,
                          auto & inputRobot = my_robots_->robot("inputRobot");
 
                          so::kine::LocalKinematics predictedWorldCentroidLocKine(
-                             observer_.getEKF().getLastPrediction().segment(observer_.posIndex(),
-                                                                            observer_.sizePos + observer_.sizeOri),
+                             observer_->getEKF().getLastPrediction().segment(observer_->posIndex(),
+                                                                             observer_->sizePos + observer_->sizeOri),
                              so::kine::Kinematics::Flags::pose);
                          so::kine::Kinematics predictedWorldCentroidKine(predictedWorldCentroidLocKine);
 
@@ -1488,34 +1973,36 @@ void MCKineticsObserver::addToLogger(const mc_control::MCController & ctl,
                        });
 
     logger.addLogEntry(category_ + "_MEKF_prediction_locPos",
-                       [this]() -> Eigen::Vector3d {
-                         return observer_.getEKF().getLastPrediction().segment(observer_.posIndex(), observer_.sizePos);
+                       [this]() -> Eigen::Vector3d
+                       {
+                         return observer_->getEKF().getLastPrediction().segment(observer_->posIndex(),
+                                                                                observer_->sizePos);
                        });
     logger.addLogEntry(
         category_ + "_MEKF_prediction_locLinVel", [this]() -> Eigen::Vector3d
-        { return observer_.getEKF().getLastPrediction().segment(observer_.linVelIndex(), observer_.sizeLinVel); });
+        { return observer_->getEKF().getLastPrediction().segment(observer_->linVelIndex(), observer_->sizeLinVel); });
     logger.addLogEntry(category_ + "_MEKF_prediction_ori",
                        [this]() -> Eigen::Quaterniond
                        {
                          so::kine::Orientation ori;
-                         ori.fromVector4(
-                             observer_.getEKF().getLastPrediction().segment(observer_.oriIndex(), observer_.sizeOri));
+                         ori.fromVector4(observer_->getEKF().getLastPrediction().segment(observer_->oriIndex(),
+                                                                                         observer_->sizeOri));
                          return ori.inverse().toQuaternion();
                        });
     logger.addLogEntry(category_ + "_MEKF_prediction_locAngVel",
                        [this]() -> Eigen::Vector3d {
-                         return observer_.getEKF().getLastPrediction().segment(observer_.angVelIndex(),
-                                                                               observer_.sizeAngVelTangent);
+                         return observer_->getEKF().getLastPrediction().segment(observer_->angVelIndex(),
+                                                                                observer_->sizeAngVelTangent);
                        });
     logger.addLogEntry(category_ + "_MEKF_prediction_unmodeledForce",
                        [this]() -> Eigen::Vector3d {
-                         return observer_.getEKF().getLastPrediction().segment(observer_.unmodeledForceIndex(),
-                                                                               observer_.sizeForce);
+                         return observer_->getEKF().getLastPrediction().segment(observer_->unmodeledForceIndex(),
+                                                                                observer_->sizeForce);
                        });
     logger.addLogEntry(category_ + "_MEKF_prediction_unmodeledTorque",
                        [this]() -> Eigen::Vector3d {
-                         return observer_.getEKF().getLastPrediction().segment(observer_.unmodeledTorqueIndex(),
-                                                                               observer_.sizeTorque);
+                         return observer_->getEKF().getLastPrediction().segment(observer_->unmodeledTorqueIndex(),
+                                                                                observer_->sizeTorque);
                        });
 
     logger.addLogEntry(category_ + "_debug_worldInputRobotKine_position",
@@ -1536,9 +2023,8 @@ void MCKineticsObserver::addToLogger(const mc_control::MCController & ctl,
     logger.addLogEntry(category_ + "_debug_worldInputRobotKine_angAcc",
                        [this]() -> Eigen::Vector3d { return my_robots_->robot("inputRobot").accW().angular(); });
 
-    for(auto & contactWithSensor : contactsManager_.contacts())
+    for(const KoContactWithSensor & contact : contactsManager_.contacts())
     {
-      const KoContactWithSensor & contact = contactWithSensor.second;
       logger.addLogEntry(category_ + "_debug_wrenchesInCentroid_" + contact.name() + "_force",
                          [&contact]() -> Eigen::Vector3d { return contact.wrenchInCentroid_.segment<3>(0); });
       logger.addLogEntry(category_ + "_debug_wrenchesInCentroid_" + contact.name() + "_torque",
@@ -1546,15 +2032,15 @@ void MCKineticsObserver::addToLogger(const mc_control::MCController & ctl,
       logger.addLogEntry(category_ + "_debug_wrenchesInCentroid_" + contact.name() + "_forceWithUnmodeled",
                          [this, &contact]() -> Eigen::Vector3d
                          {
-                           return observer_.getCurrentStateVector().segment(observer_.unmodeledForceIndex(),
-                                                                            observer_.sizeForce)
+                           return observer_->getCurrentStateVector().segment(observer_->unmodeledForceIndex(),
+                                                                             observer_->sizeForce)
                                   + contact.wrenchInCentroid_.segment<3>(0);
                          });
       logger.addLogEntry(category_ + "_debug_wrenchesInCentroid_" + contact.name() + "_torqueWithUnmodeled",
                          [this, &contact]() -> Eigen::Vector3d
                          {
-                           return observer_.getCurrentStateVector().segment(observer_.unmodeledTorqueIndex(),
-                                                                            observer_.sizeTorque)
+                           return observer_->getCurrentStateVector().segment(observer_->unmodeledTorqueIndex(),
+                                                                             observer_->sizeTorque)
                                   + contact.wrenchInCentroid_.segment<3>(3);
                          });
     }
@@ -1587,6 +2073,11 @@ void MCKineticsObserver::addToGUI(const mc_control::MCController &,
                                   mc_rtc::gui::StateBuilder & gui,
                                   const std::vector<std::string> & category)
 {
+#ifdef MC_STATE_OBSERVATION_HEADLESS
+  // no GUI is attached to the headless builds
+  (void)gui;
+  (void)category;
+#else
   using namespace mc_rtc::gui;
   // clang-format off
   std::vector<std::string> covsCategory = category;
@@ -1635,12 +2126,19 @@ void MCKineticsObserver::addToGUI(const mc_control::MCController &,
                                                                   }));
   }
   // clang-format on
+#endif
 }
 
 void MCKineticsObserver::addContactToGui(const mc_control::MCController & ctl,
                                          KoContactWithSensor & contact,
                                          mc_rtc::Logger & logger)
 {
+#ifdef MC_STATE_OBSERVATION_HEADLESS
+  // no GUI is attached to the headless builds
+  (void)ctl;
+  (void)contact;
+  (void)logger;
+#else
   std::vector<std::string> contactCategory;
   contactCategory.insert(contactCategory.end(),
                          {"ObserverPipelines", ctl.observerPipeline().name(), name(), "Contacts"});
@@ -1655,33 +2153,45 @@ void MCKineticsObserver::addContactToGui(const mc_control::MCController & ctl,
                               {
                                 contact.sensorEnabled_ = true;
                                 mc_rtc::log::info("{}: contact's sensors enabled", contact.name());
-                                if(contact.isSet()) { addContactMeasurementsLogEntries(logger, contact); }
+                                if(contact.isSet() && !withPreRegisteredContactLogs_)
+                                {
+                                  addContactMeasurementsLogEntries(logger, contact);
+                                }
                               }
                               else
                               {
                                 contact.sensorEnabled_ = false;
                                 mc_rtc::log::info("{}: contact's sensors disabled", contact.name());
-                                if(contact.isSet()) { removeContactMeasurementsLogEntries(logger, contact); }
+                                if(contact.isSet() && !withPreRegisteredContactLogs_)
+                                {
+                                  removeContactMeasurementsLogEntries(logger, contact);
+                                }
                               }
                             }));
+#endif
 }
 
 void MCKineticsObserver::addContactLogEntries(const mc_control::MCController & ctl,
                                               mc_rtc::Logger & logger,
                                               const KoContactWithSensor & contact)
 {
+  // the state of the contact in the Kinetics Observer is valid only while the contact is set, which is not always the
+  // case if the contact logs are pre-registered.
   logger.addLogEntry(category_ + "_MEKF_estimatedState_contact_" + contact.name() + "_position", &contact,
-                     [this, &contact]() -> Eigen::Vector3d {
-                       return observer_.getCurrentStateVector().segment(observer_.contactPosIndex(contact.id()),
-                                                                        observer_.sizePos);
+                     [this, &contact]() -> Eigen::Vector3d
+                     {
+                       if(!contact.isSet()) { return Eigen::Vector3d::Zero(); }
+                       return observer_->getCurrentStateVector().segment(observer_->contactPosIndex(contact.id()),
+                                                                         observer_->sizePos);
                      });
   logger.addLogEntry(category_ + "_MEKF_estimatedState_contact_" + contact.name() + "_orientation", &contact,
                      [this, &contact]() -> Eigen::Quaternion<double>
                      {
+                       if(!contact.isSet()) { return Eigen::Quaterniond::Identity(); }
                        so::kine::Orientation ori;
                        return ori
-                           .fromVector4(observer_.getCurrentStateVector().segment(
-                               observer_.contactOriIndex(contact.id()), observer_.sizeOri))
+                           .fromVector4(observer_->getCurrentStateVector().segment(
+                               observer_->contactOriIndex(contact.id()), observer_->sizeOri))
                            .inverse()
                            .toQuaternion();
                      });
@@ -1689,73 +2199,67 @@ void MCKineticsObserver::addContactLogEntries(const mc_control::MCController & c
                      &contact,
                      [this, &contact]() -> so::Vector3
                      {
+                       if(!contact.isSet()) { return so::Vector3::Zero(); }
                        so::kine::Orientation ori;
                        return so::kine::rotationMatrixToRollPitchYaw(
-                           ori.fromVector4(observer_.getCurrentStateVector().segment(
-                                               observer_.contactOriIndex(contact.id()), observer_.sizeOri))
+                           ori.fromVector4(observer_->getCurrentStateVector().segment(
+                                               observer_->contactOriIndex(contact.id()), observer_->sizeOri))
                                .toMatrix3());
                      });
   logger.addLogEntry(category_ + "_MEKF_estimatedState_contact_" + contact.name() + "_forces", &contact,
-                     [this, &contact]() -> Eigen::Vector3d {
-                       return observer_.getCurrentStateVector().segment(observer_.contactForceIndex(contact.id()),
-                                                                        observer_.sizeForce);
+                     [this, &contact]() -> Eigen::Vector3d
+                     {
+                       if(!contact.isSet()) { return Eigen::Vector3d::Zero(); }
+                       return observer_->getCurrentStateVector().segment(observer_->contactForceIndex(contact.id()),
+                                                                         observer_->sizeForce);
                      });
   logger.addLogEntry(category_ + "_MEKF_estimatedState_contact_" + contact.name() + "_torques", &contact,
                      [this, &contact]() -> Eigen::Vector3d
                      {
+                       if(!contact.isSet()) { return Eigen::Vector3d::Zero(); }
                        return globalCentroidKinematics_.orientation.toMatrix3()
-                              * observer_.getCurrentStateVector().segment(observer_.contactTorqueIndex(contact.id()),
-                                                                          observer_.sizeTorque);
+                              * observer_->getCurrentStateVector().segment(observer_->contactTorqueIndex(contact.id()),
+                                                                           observer_->sizeTorque);
                      });
   logger.addLogEntry(category_ + "_MEKF_stateCovariances_contact_" + contact.name() + "_position_", &contact,
                      [this, &contact]() -> Eigen::Vector3d
                      {
-                       return observer_.getEKF()
-                           .getStateCovariance()
-                           .block(observer_.contactPosIndexTangent(contact.id()),
-                                  observer_.contactPosIndexTangent(contact.id()), observer_.sizePosTangent,
-                                  observer_.sizePosTangent)
-                           .diagonal();
+                       if(!contact.isSet()) { return Eigen::Vector3d::Zero(); }
+                       return stateCovarianceDiagonal().segment(observer_->contactPosIndexTangent(contact.id()),
+                                                               observer_->sizePosTangent);
                      });
   logger.addLogEntry(category_ + "_MEKF_stateCovariances_contact_" + contact.name() + "_orientation_", &contact,
                      [this, &contact]() -> Eigen::Vector3d
                      {
-                       return observer_.getEKF()
-                           .getStateCovariance()
-                           .block(observer_.contactOriIndexTangent(contact.id()),
-                                  observer_.contactOriIndexTangent(contact.id()), observer_.sizeOriTangent,
-                                  observer_.sizeOriTangent)
-                           .diagonal();
+                       if(!contact.isSet()) { return Eigen::Vector3d::Zero(); }
+                       return stateCovarianceDiagonal().segment(observer_->contactOriIndexTangent(contact.id()),
+                                                               observer_->sizeOriTangent);
                      });
   logger.addLogEntry(category_ + "_MEKF_stateCovariances_contact_" + contact.name() + "_Force_", &contact,
                      [this, &contact]() -> Eigen::Vector3d
                      {
-                       return observer_.getEKF()
-                           .getStateCovariance()
-                           .block(observer_.contactForceIndexTangent(contact.id()),
-                                  observer_.contactForceIndexTangent(contact.id()), observer_.sizeForceTangent,
-                                  observer_.sizeForceTangent)
-                           .diagonal();
+                       if(!contact.isSet()) { return Eigen::Vector3d::Zero(); }
+                       return stateCovarianceDiagonal().segment(observer_->contactForceIndexTangent(contact.id()),
+                                                               observer_->sizeForceTangent);
                      });
   logger.addLogEntry(category_ + "_MEKF_stateCovariances_contact_" + contact.name() + "_Torque_", &contact,
                      [this, &contact]() -> Eigen::Vector3d
                      {
-                       return observer_.getEKF()
-                           .getStateCovariance()
-                           .block(observer_.contactTorqueIndexTangent(contact.id()),
-                                  observer_.contactTorqueIndexTangent(contact.id()), observer_.sizeTorqueTangent,
-                                  observer_.sizeTorqueTangent)
-                           .diagonal();
+                       if(!contact.isSet()) { return Eigen::Vector3d::Zero(); }
+                       return stateCovarianceDiagonal().segment(observer_->contactTorqueIndexTangent(contact.id()),
+                                                               observer_->sizeTorqueTangent);
                      });
 
   logger.addLogEntry(
       category_ + "_MEKF_prediction_contact_" + contact.name() + "_poseWorldFromCentroid_pos", &contact,
       [this, &contact]() -> Eigen::Vector3d
       {
+        if(!contact.isSet()) { return Eigen::Vector3d::Zero(); }
         auto & inputRobot = my_robots_->robot("inputRobot");
 
         so::kine::LocalKinematics predictedWorldCentroidLocKine(
-            observer_.getEKF().getLastPrediction().segment(observer_.posIndex(), observer_.sizePos + observer_.sizeOri),
+            observer_->getEKF().getLastPrediction().segment(observer_->posIndex(),
+                                                            observer_->sizePos + observer_->sizeOri),
             so::kine::Kinematics::Flags::pose);
         so::kine::Kinematics predictedWorldCentroidKine(predictedWorldCentroidLocKine);
         so::kine::Kinematics fbCentroidKine;
@@ -1771,9 +2275,10 @@ void MCKineticsObserver::addContactLogEntries(const mc_control::MCController & c
   logger.addLogEntry(category_ + "_MEKF_prediction_contact_" + contact.name() + "_poseWorldFromCentroid_ori", &contact,
                      [this, &contact]() -> Eigen::Quaterniond
                      {
+                       if(!contact.isSet()) { return Eigen::Quaterniond::Identity(); }
                        so::kine::Orientation predictedWorldCentroidLocKine;
                        predictedWorldCentroidLocKine.fromVector4(
-                           observer_.getEKF().getLastPrediction().segment(observer_.oriIndex(), observer_.sizeOri));
+                           observer_->getEKF().getLastPrediction().segment(observer_->oriIndex(), observer_->sizeOri));
 
                        so::kine::Orientation predictedWorldContactOri(so::Matrix3(
                            predictedWorldCentroidLocKine.toMatrix3() * contact.fbContactKine_.orientation.toMatrix3()));
@@ -1785,12 +2290,13 @@ void MCKineticsObserver::addContactLogEntries(const mc_control::MCController & c
                      &contact,
                      [this, &contact]() -> Eigen::Vector3d
                      {
+                       if(!contact.isSet()) { return Eigen::Vector3d::Zero(); }
                        auto & inputRobot = my_robots_->robot("inputRobot");
 
                        so::kine::LocalKinematics predictedWorldCentroidLocKine(
-                           observer_.getEKF().getLastPrediction().segment(
-                               observer_.posIndex(),
-                               observer_.sizePos + observer_.sizeOri + observer_.sizeLinVel + observer_.sizeAngVel),
+                           observer_->getEKF().getLastPrediction().segment(
+                               observer_->posIndex(),
+                               observer_->sizePos + observer_->sizeOri + observer_->sizeLinVel + observer_->sizeAngVel),
                            so::kine::Kinematics::Flags::pose | so::kine::Kinematics::Flags::vel);
                        so::kine::Kinematics predictedWorldCentroidKine(predictedWorldCentroidLocKine);
 
@@ -1810,12 +2316,13 @@ void MCKineticsObserver::addContactLogEntries(const mc_control::MCController & c
                      &contact,
                      [this, &contact]() -> Eigen::Vector3d
                      {
+                       if(!contact.isSet()) { return Eigen::Vector3d::Zero(); }
                        auto & inputRobot = my_robots_->robot("inputRobot");
 
                        so::kine::LocalKinematics predictedWorldCentroidLocKine(
-                           observer_.getEKF().getLastPrediction().segment(
-                               observer_.posIndex(),
-                               observer_.sizePos + observer_.sizeOri + observer_.sizeLinVel + observer_.sizeAngVel),
+                           observer_->getEKF().getLastPrediction().segment(
+                               observer_->posIndex(),
+                               observer_->sizePos + observer_->sizeOri + observer_->sizeLinVel + observer_->sizeAngVel),
                            so::kine::Kinematics::Flags::pose | so::kine::Kinematics::Flags::vel);
                        so::kine::Kinematics predictedWorldCentroidKine(predictedWorldCentroidLocKine);
 
@@ -1832,64 +2339,90 @@ void MCKineticsObserver::addContactLogEntries(const mc_control::MCController & c
                      });
 
   logger.addLogEntry(category_ + "_MEKF_prediction_contact_" + contact.name() + "_restPos_W", &contact,
-                     [this, &contact]() -> Eigen::Vector3d {
-                       return observer_.getEKF().getLastPrediction().segment(observer_.contactPosIndex(contact.id()),
-                                                                             observer_.sizePos);
+                     [this, &contact]() -> Eigen::Vector3d
+                     {
+                       if(!contact.isSet()) { return Eigen::Vector3d::Zero(); }
+                       return observer_->getEKF().getLastPrediction().segment(observer_->contactPosIndex(contact.id()),
+                                                                              observer_->sizePos);
                      });
   logger.addLogEntry(category_ + "_MEKF_prediction_contact_" + contact.name() + "_restOri_W", &contact,
                      [this, &contact]() -> Eigen::Quaternion<double>
                      {
+                       if(!contact.isSet()) { return Eigen::Quaterniond::Identity(); }
                        so::kine::Orientation ori;
                        return ori
-                           .fromVector4(observer_.getEKF().getLastPrediction().segment(
-                               observer_.contactOriIndex(contact.id()), observer_.sizeOri))
+                           .fromVector4(observer_->getEKF().getLastPrediction().segment(
+                               observer_->contactOriIndex(contact.id()), observer_->sizeOri))
                            .inverse()
                            .toQuaternion();
                      });
   logger.addLogEntry(category_ + "_MEKF_prediction_contact_" + contact.name() + "_forces", &contact,
                      [this, &contact]() -> Eigen::Vector3d
                      {
-                       return observer_.getEKF().getLastPrediction().segment(observer_.contactForceIndex(contact.id()),
-                                                                             observer_.sizeForce);
+                       if(!contact.isSet()) { return Eigen::Vector3d::Zero(); }
+                       return observer_->getEKF().getLastPrediction().segment(
+                           observer_->contactForceIndex(contact.id()), observer_->sizeForce);
                      });
   logger.addLogEntry(category_ + "_MEKF_prediction_contact_" + contact.name() + "_torques", &contact,
                      [this, &contact]() -> Eigen::Vector3d
                      {
-                       return observer_.getEKF().getLastPrediction().segment(observer_.contactTorqueIndex(contact.id()),
-                                                                             observer_.sizeTorque);
+                       if(!contact.isSet()) { return Eigen::Vector3d::Zero(); }
+                       return observer_->getEKF().getLastPrediction().segment(
+                           observer_->contactTorqueIndex(contact.id()), observer_->sizeTorque);
                      });
 
   logger.addLogEntry(category_ + "_MEKF_debug_contactWrench_Centroid_" + contact.name() + "_force", &contact,
                      [this, &contact]() -> Eigen::Vector3d
-                     { return observer_.getCentroidContactWrench(contact.id()).segment(0, observer_.sizeForce); });
+                     {
+                       if(!contact.isSet()) { return Eigen::Vector3d::Zero(); }
+                       return observer_->getCentroidContactWrench(contact.id()).segment(0, observer_->sizeForce);
+                     });
 
   logger.addLogEntry(category_ + "_MEKF_debug_contactWrench_Centroid_" + contact.name() + "_torque", &contact,
                      [this, &contact]() -> Eigen::Vector3d
-                     { return observer_.getCentroidContactWrench(contact.id()).segment(3, observer_.sizeTorque); });
+                     {
+                       if(!contact.isSet()) { return Eigen::Vector3d::Zero(); }
+                       return observer_->getCentroidContactWrench(contact.id()).segment(3, observer_->sizeTorque);
+                     });
 
   logger.addLogEntry(category_ + "_debug_contactKine_" + contact.name() + "_inputCentroidContactKine_position",
-                     &contact, [this, &contact]() -> Eigen::Vector3d
-                     { return observer_.getCentroidContactInputKine(contact.id()).position(); });
+                     &contact,
+                     [this, &contact]() -> Eigen::Vector3d
+                     {
+                       if(!contact.isSet()) { return Eigen::Vector3d::Zero(); }
+                       return observer_->getCentroidContactInputKine(contact.id()).position();
+                     });
 
   logger.addLogEntry(category_ + "_debug_contactKine_" + contact.name() + "_inputCentroidContactKine_orientation",
                      &contact,
-                     [this, &contact]() -> Eigen::Quaternion<double> {
-                       return observer_.getCentroidContactInputKine(contact.id()).orientation.inverse().toQuaternion();
+                     [this, &contact]() -> Eigen::Quaternion<double>
+                     {
+                       if(!contact.isSet()) { return Eigen::Quaterniond::Identity(); }
+                       return observer_->getCentroidContactInputKine(contact.id()).orientation.inverse().toQuaternion();
                      });
   logger.addLogEntry(category_ + "_debug_contactKine_" + contact.name() + "_inputCentroidContactKine_linVel", &contact,
                      [this, &contact]() -> Eigen::Vector3d
-                     { return observer_.getCentroidContactInputKine(contact.id()).linVel(); });
+                     {
+                       if(!contact.isSet()) { return Eigen::Vector3d::Zero(); }
+                       return observer_->getCentroidContactInputKine(contact.id()).linVel();
+                     });
 
   logger.addLogEntry(category_ + "_debug_contactKine_" + contact.name() + "_inputCentroidContactKine_angVel", &contact,
                      [this, &contact]() -> Eigen::Vector3d
-                     { return observer_.getCentroidContactInputKine(contact.id()).angVel(); });
+                     {
+                       if(!contact.isSet()) { return Eigen::Vector3d::Zero(); }
+                       return observer_->getCentroidContactInputKine(contact.id()).angVel();
+                     });
   logger.addLogEntry(
       category_ + "_debug_contactKine_" + contact.name() + "_realRobot_position", &contact,
       [this, &contact, &ctl]() -> Eigen::Vector3d
       {
         const auto & robot = ctl.robot(robot_);
         const auto & realRobot = ctl.realRobot(robot_);
-        return getContactWorldKinematics(contact, realRobot, robot.forceSensor(contact.forceSensor())).position();
+        so::kine::Kinematics worldContactKine;
+        getContactWorldKinematics(contact, realRobot, robot.forceSensors()[contact.forceSensorIndex()],
+                                  worldContactKine);
+        return worldContactKine.position();
       });
 
   logger.addLogEntry(
@@ -1897,38 +2430,67 @@ void MCKineticsObserver::addContactLogEntries(const mc_control::MCController & c
       [this, &contact, &ctl]() -> Eigen::Vector3d
       {
         const auto & robot = ctl.robot(robot_);
-        return getContactWorldKinematics(contact, robot, robot.forceSensor(contact.forceSensor())).position();
+        so::kine::Kinematics worldContactKine;
+        getContactWorldKinematics(contact, robot, robot.forceSensors()[contact.forceSensorIndex()], worldContactKine);
+        return worldContactKine.position();
       });
 
   logger.addLogEntry(category_ + "_debug_contactKine_" + contact.name() + "_worldcontactKineFromCentroid_position",
-                     &contact, [this, &contact]() -> Eigen::Vector3d
-                     { return observer_.getWorldContactKineFromCentroid(contact.id()).position(); });
+                     &contact,
+                     [this, &contact]() -> Eigen::Vector3d
+                     {
+                       if(!contact.isSet()) { return Eigen::Vector3d::Zero(); }
+                       return observer_->getWorldContactKineFromCentroid(contact.id()).position();
+                     });
 
   logger.addLogEntry(
       category_ + "_debug_contactKine_" + contact.name() + "_worldcontactKineFromCentroid_orientation", &contact,
       [this, &contact]() -> Eigen::Quaternion<double>
-      { return observer_.getWorldContactKineFromCentroid(contact.id()).orientation.inverse().toQuaternion(); });
+      {
+        if(!contact.isSet()) { return Eigen::Quaterniond::Identity(); }
+        return observer_->getWorldContactKineFromCentroid(contact.id()).orientation.inverse().toQuaternion();
+      });
 
   logger.addLogEntry(category_ + "_debug_contactKine_" + contact.name() + "_worldcontactKineFromCentroid_linVel",
-                     &contact, [this, &contact]() -> Eigen::Vector3d
-                     { return observer_.getWorldContactKineFromCentroid(contact.id()).linVel(); });
+                     &contact,
+                     [this, &contact]() -> Eigen::Vector3d
+                     {
+                       if(!contact.isSet()) { return Eigen::Vector3d::Zero(); }
+                       return observer_->getWorldContactKineFromCentroid(contact.id()).linVel();
+                     });
 
   logger.addLogEntry(category_ + "_debug_contactKine_" + contact.name() + "_worldcontactKineFromCentroid_angVel",
-                     &contact, [this, &contact]() -> Eigen::Vector3d
-                     { return observer_.getWorldContactKineFromCentroid(contact.id()).angVel(); });
+                     &contact,
+                     [this, &contact]() -> Eigen::Vector3d
+                     {
+                       if(!contact.isSet()) { return Eigen::Vector3d::Zero(); }
+                       return observer_->getWorldContactKineFromCentroid(contact.id()).angVel();
+                     });
 
   logger.addLogEntry(category_ + "_debug_contactKine_" + contact.name() + "_inputUserContactKine_position", &contact,
                      [this, &contact]() -> Eigen::Vector3d
-                     { return observer_.getUserContactInputKine(contact.id()).position(); });
+                     {
+                       if(!contact.isSet()) { return Eigen::Vector3d::Zero(); }
+                       return observer_->getUserContactInputKine(contact.id()).position();
+                     });
   logger.addLogEntry(category_ + "_debug_contactKine_" + contact.name() + "_inputUserContactKine_orientation", &contact,
                      [this, &contact]() -> Eigen::Quaternion<double>
-                     { return observer_.getUserContactInputKine(contact.id()).orientation.inverse().toQuaternion(); });
+                     {
+                       if(!contact.isSet()) { return Eigen::Quaterniond::Identity(); }
+                       return observer_->getUserContactInputKine(contact.id()).orientation.inverse().toQuaternion();
+                     });
   logger.addLogEntry(category_ + "_debug_contactKine_" + contact.name() + "_inputUserContactKine_linVel", &contact,
                      [this, &contact]() -> Eigen::Vector3d
-                     { return observer_.getUserContactInputKine(contact.id()).linVel(); });
+                     {
+                       if(!contact.isSet()) { return Eigen::Vector3d::Zero(); }
+                       return observer_->getUserContactInputKine(contact.id()).linVel();
+                     });
   logger.addLogEntry(category_ + "_debug_contactKine_" + contact.name() + "_inputUserContactKine_angVel", &contact,
                      [this, &contact]() -> Eigen::Vector3d
-                     { return observer_.getUserContactInputKine(contact.id()).angVel(); });
+                     {
+                       if(!contact.isSet()) { return Eigen::Vector3d::Zero(); }
+                       return observer_->getUserContactInputKine(contact.id()).angVel();
+                     });
 
   logger.addLogEntry(category_ + "_debug_contactState_isSet_" + contact.name(), &contact,
                      [&contact]() -> std::string { return contact.isSet() ? "Set" : "notSet"; });
@@ -1940,76 +2502,109 @@ void MCKineticsObserver::addContactMeasurementsLogEntries(mc_rtc::Logger & logge
   logger.addLogEntry(category_ + "_MEKF_innovation_contacts_" + contact.name() + "_position", &contact,
                      [this, &contact]() -> Eigen::Vector3d
                      {
-                       return observer_.getEKF().getInnovation().segment(observer_.contactPosIndexTangent(contact.id()),
-                                                                         observer_.sizePosTangent);
+                       if(!contact.isSet()) { return Eigen::Vector3d::Zero(); }
+                       return observer_->getEKF().getInnovation().segment(
+                           observer_->contactPosIndexTangent(contact.id()), observer_->sizePosTangent);
                      });
   logger.addLogEntry(category_ + "_MEKF_innovation_contacts_" + contact.name() + "_orientation", &contact,
                      [this, &contact]() -> Eigen::Vector3d
                      {
-                       return observer_.getEKF().getInnovation().segment(observer_.contactOriIndexTangent(contact.id()),
-                                                                         observer_.sizeOriTangent);
+                       if(!contact.isSet()) { return Eigen::Vector3d::Zero(); }
+                       return observer_->getEKF().getInnovation().segment(
+                           observer_->contactOriIndexTangent(contact.id()), observer_->sizeOriTangent);
                      });
   logger.addLogEntry(category_ + "_MEKF_innovation_contacts_" + contact.name() + "_force", &contact,
                      [this, &contact]() -> Eigen::Vector3d
                      {
-                       return observer_.getEKF().getInnovation().segment(
-                           observer_.contactForceIndexTangent(contact.id()), observer_.sizeForceTangent);
+                       if(!contact.isSet()) { return Eigen::Vector3d::Zero(); }
+                       return observer_->getEKF().getInnovation().segment(
+                           observer_->contactForceIndexTangent(contact.id()), observer_->sizeForceTangent);
                      });
   logger.addLogEntry(category_ + "_MEKF_innovation_contacts_" + contact.name() + "_torque", &contact,
                      [this, &contact]() -> Eigen::Vector3d
                      {
-                       return observer_.getEKF().getInnovation().segment(
-                           observer_.contactTorqueIndexTangent(contact.id()), observer_.sizeTorqueTangent);
+                       if(!contact.isSet()) { return Eigen::Vector3d::Zero(); }
+                       return observer_->getEKF().getInnovation().segment(
+                           observer_->contactTorqueIndexTangent(contact.id()), observer_->sizeTorqueTangent);
                      });
 
   logger.addLogEntry(category_ + "_MEKF_measurements_contacts_force_" + contact.name() + "_viscoAfterCorrection",
-                     &contact, [&contact]() -> Eigen::Vector3d
-                     { return contact.viscoElasticWrenchAfterCorrection_.segment(0, 3); });
+                     &contact,
+                     [this, &contact]() -> Eigen::Vector3d
+                     {
+                       if(!contact.isSet()) { return Eigen::Vector3d::Zero(); }
+                       return viscoElasticWrenchAfterCorrection(contact).segment(0, 3);
+                     });
   logger.addLogEntry(category_ + "_MEKF_measurements_contacts_torque_" + contact.name() + "_viscoAfterCorrection",
-                     &contact, [&contact]() -> Eigen::Vector3d
-                     { return contact.viscoElasticWrenchAfterCorrection_.segment(3, 3); });
+                     &contact,
+                     [this, &contact]() -> Eigen::Vector3d
+                     {
+                       if(!contact.isSet()) { return Eigen::Vector3d::Zero(); }
+                       return viscoElasticWrenchAfterCorrection(contact).segment(3, 3);
+                     });
 
-  // Measurements
+  // Measurements. The measurement index of the contact is valid only while it is set with its sensor enabled, which is
+  // not always the case if the contact logs are pre-registered or after the sensor got disabled from the gui.
   logger.addLogEntry(category_ + "_MEKF_measurements_contacts_force_" + contact.name() + "_measured", &contact,
                      [this, &contact]() -> Eigen::Vector3d
                      {
-                       return observer_.getEKF().getLastMeasurement().segment(
-                           observer_.getContactMeasIndexByNum(contact.id()), observer_.sizeForce);
+                       if(!contact.isSet() || !contact.sensorEnabled_) { return Eigen::Vector3d::Zero(); }
+                       return observer_->getEKF().getLastMeasurement().segment(
+                           observer_->getContactMeasIndexByNum(contact.id()), observer_->sizeForce);
                      });
   logger.addLogEntry(category_ + "_MEKF_measurements_contacts_force_" + contact.name() + "_predicted", &contact,
                      [this, &contact]() -> Eigen::Vector3d
                      {
-                       return observer_.getEKF().getLastPredictedMeasurement().segment(
-                           observer_.getContactMeasIndexByNum(contact.id()), observer_.sizeForce);
+                       if(!contact.isSet() || !contact.sensorEnabled_) { return Eigen::Vector3d::Zero(); }
+                       return observer_->getEKF().getLastPredictedMeasurement().segment(
+                           observer_->getContactMeasIndexByNum(contact.id()), observer_->sizeForce);
                      });
   logger.addLogEntry(category_ + "_MEKF_measurements_contacts_force_" + contact.name() + "_corrected", &contact,
-                     [this, &contact]() -> Eigen::Vector3d {
-                       return correctedMeasurements_.segment(observer_.getContactMeasIndexByNum(contact.id()),
-                                                             observer_.sizeForce);
+                     [this, &contact]() -> Eigen::Vector3d
+                     {
+                       if(!contact.isSet() || !contact.sensorEnabled_) { return Eigen::Vector3d::Zero(); }
+                       return correctedMeasurements().segment(observer_->getContactMeasIndexByNum(contact.id()),
+                                                             observer_->sizeForce);
                      });
   logger.addLogEntry(category_ + "_MEKF_measurements_contacts_torque_" + contact.name() + "_measured", &contact,
                      [this, &contact]() -> Eigen::Vector3d
                      {
-                       return observer_.getEKF().getLastMeasurement().segment(
-                           observer_.getContactMeasIndexByNum(contact.id()) + observer_.sizeForce,
-                           observer_.sizeTorque);
+                       if(!contact.isSet() || !contact.sensorEnabled_) { return Eigen::Vector3d::Zero(); }
+                       return observer_->getEKF().getLastMeasurement().segment(
+                           observer_->getContactMeasIndexByNum(contact.id()) + observer_->sizeForce,
+                           observer_->sizeTorque);
                      });
   logger.addLogEntry(category_ + "_MEKF_measurements_contacts_torque_" + contact.name() + "_predicted", &contact,
                      [this, &contact]() -> Eigen::Vector3d
                      {
-                       return observer_.getEKF().getLastPredictedMeasurement().segment(
-                           observer_.getContactMeasIndexByNum(contact.id()) + observer_.sizeForce,
-                           observer_.sizeTorque);
+                       if(!contact.isSet() || !contact.sensorEnabled_) { return Eigen::Vector3d::Zero(); }
+                       return observer_->getEKF().getLastPredictedMeasurement().segment(
+                           observer_->getContactMeasIndexByNum(contact.id()) + observer_->sizeForce,
+                           observer_->sizeTorque);
                      });
   logger.addLogEntry(category_ + "_MEKF_measurements_contacts_torque_" + contact.name() + "_corrected", &contact,
                      [this, &contact]() -> Eigen::Vector3d
                      {
-                       return correctedMeasurements_.segment(observer_.getContactMeasIndexByNum(contact.id())
-                                                                 + observer_.sizeForce,
-                                                             observer_.sizeTorque);
+                       if(!contact.isSet() || !contact.sensorEnabled_) { return Eigen::Vector3d::Zero(); }
+                       return correctedMeasurements().segment(observer_->getContactMeasIndexByNum(contact.id())
+                                                                 + observer_->sizeForce,
+                                                             observer_->sizeTorque);
                      });
 }
 
+void MCKineticsObserver::addPreRegisteredContactLogEntries(const mc_control::MCController & ctl,
+                                                           mc_rtc::Logger & logger,
+                                                           const KoContactWithSensor & contact)
+{
+  logger.addLogEntry(category_ + "_debug_contactState_valid_" + contact.name(), &contact,
+                     [&contact]() -> bool { return contact.isSet(); });
+  logger.addLogEntry(category_ + "_debug_contactState_measurementsValid_" + contact.name(), &contact,
+                     [&contact]() -> bool { return contact.isSet() && contact.sensorEnabled_; });
+
+  addContactLogEntries(ctl, logger, contact);
+  addContactMeasurementsLogEntries(logger, contact);
+}
+
 void MCKineticsObserver::removeContactLogEntries(mc_rtc::Logger & logger, const KoContactWithSensor & contact)
 {
   logger.removeLogEntries(&contact);
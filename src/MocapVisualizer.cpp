@@ -176,12 +176,14 @@ void MocapVisualizer::updateContacts(const mc_control::MCController & ctl)
 
   auto onNewContact = [this, &ctl, &logger](MocapContact & newContact)
   {
-    getContactKinematics(newContact, ctl.robot().forceSensor(newContact.forceSensor()));
+    getContactKinematics(newContact, ctl.robot(robot_).forceSensors()[newContact.forceSensorIndex()]);
     addContactsLogs(newContact, logger);
   };
 
   auto onMaintainedContact = [this, &ctl](MocapContact & maintainedContact)
-  { getContactKinematics(maintainedContact, ctl.robot().forceSensor(maintainedContact.forceSensor())); };
+  {
+    getContactKinematics(maintainedContact, ctl.robot(robot_).forceSensors()[maintainedContact.forceSensorIndex()]);
+  };
 
   auto onRemovedContact = [&logger](MocapContact & removedContact) { logger.removeLogEntries(&removedContact); };
 
@@ -94,7 +94,6 @@ void NaiveOdometry::configure(const mc_control::MCController & ctl, const mc_rtc
 
 void NaiveOdometry::reset(const mc_control::MCController & ctl)
 {
-  const auto & robot = ctl.robot(robot_);
   const auto & realRobot = ctl.realRobot(robot_);
   const auto & realRobotModule = realRobot.module();
 
@@ -124,10 +123,13 @@ void NaiveOdometry::reset(const mc_control::MCController & ctl)
 
   mass(ctl.realRobot(robot_).mass());
 
+#ifndef MC_STATE_OBSERVATION_HEADLESS
+  const auto & robot = ctl.robot(robot_);
   my_robots_ = mc_rbdyn::Robots::make();
   my_robots_->robotCopy(robot, robot.name());
   ctl.gui()->addElement(
       {"Robots"}, mc_rtc::gui::Robot(name(), [this]() -> const mc_rbdyn::Robot & { return my_robots_->robot(); }));
+#endif
 
   X_0_fb_.translation() = realRobot.posW().translation();
   X_0_fb_.rotation() = realRobot.posW().rotation();
@@ -152,9 +154,11 @@ bool NaiveOdometry::run(const mc_control::MCController & ctl)
     odometryManager_.run(ctl, kineParams);
   }
 
+#ifndef MC_STATE_OBSERVATION_HEADLESS
   /* Update of the visual representation (only a visual feature) of the observed robot */
   my_robots_->robot().mbc().q = ctl.realRobot().mbc().q;
   update(my_robots_->robot());
+#endif
 
   return true;
 }
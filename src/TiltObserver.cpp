@@ -3,6 +3,7 @@
 #include "mc_state_observation/measurements/measurements.h"
 #include <mc_state_observation/TiltObserver.h>
 #include <mc_state_observation/gui_helpers.h>
+#include <mc_state_observation/profiling/AllocationTracking.h>
 
 namespace mc_state_observation
 {
@@ -18,6 +19,17 @@ TiltObserver::TiltObserver(const std::string & type, double dt, bool asBackup)
   asBackup_ = asBackup;
 }
 
+TiltObserver::~TiltObserver()
+{
+  // the entry of the contact events accesses the members of this observer
+  if(datastore_ && datastore_->has(name() + "::ContactEvents")) { datastore_->remove(name() + "::ContactEvents"); }
+  // the state of the backup is saved by the Kinetics Observer
+  if(checkpointFile_.empty() || xk_.size() == 0) { return; }
+  checkpoint::Checkpoint checkpoint;
+  saveState(checkpoint, name());
+  checkpoint.trySave(checkpointFile_, name());
+}
+
 void TiltObserver::configure(const mc_control::MCController & ctl, const mc_rtc::Configuration & config)
 {
   auto contactsConfig = config("contacts");
@@ -50,6 +62,11 @@ void TiltObserver::configure(const mc_control::MCController & ctl, const mc_rtc:
     }
   }
 
+  config("partialKinematics", partialKinematics_);
+  config("anchorFrameBodies", anchorFrameBodies_);
+  // when used as a backup, the checkpoint is handled by the Kinetics Observer
+  if(!asBackup_) { config("checkpointFile", checkpointFile_); }
+
   std::string odometryTypeStr = static_cast<std::string>(leggedOdomConfig("odometryType"));
   // we set the odometry type now because it will be necessary for the next check
   setOdometryType(measurements::stringToOdometryType(odometryTypeStr, name()));
@@ -59,6 +76,9 @@ void TiltObserver::configure(const mc_control::MCController & ctl, const mc_rtc:
   {
     bool verbose = config("verbose", true);
     bool withYawEstimation = config("withYawEstimation", true);
+    // number of contacts used for the yaw estimation, the ones with the highest force are used
+    size_t maxOrientationContacts = config("maxOrientationContacts", size_t{2});
+    bool withPreRegisteredContactLogs = config("withPreRegisteredContactLogs", false);
 
     // surfaces used for the contact detection. If the desired detection method doesn't use surfaces, we make sure this
     // list is not filled in the configuration file to avoid the use of an undesired method.
@@ -79,7 +99,9 @@ void TiltObserver::configure(const mc_control::MCController & ctl, const mc_rtc:
 
     odometry::LeggedOdometryManager::Configuration odomConfig(robot_, name(), odometryManager_.odometryType_);
     odomConfig.velocityUpdate(odometry::LeggedOdometryManager::VelocityUpdate::NoUpdate)
-        .withYawEstimation(withYawEstimation);
+        .withYawEstimation(withYawEstimation)
+        .maxOrientationContacts(maxOrientationContacts)
+        .withPreRegisteredContactLogs(withPreRegisteredContactLogs);
     if(asBackup_) { odomConfig.withModeSwitchInGui(false); }
 
     if(contactsDetectionMethod == LoContactsManager::ContactsDetection::Surfaces)
@@ -124,6 +146,12 @@ void TiltObserver::configure(const mc_control::MCController & ctl, const mc_rtc:
       odometryManager_.init(ctl, odomConfig, contactsConf);
     }
   }
+
+  // the transitions of the contacts can be polled by other components (logging, planning) outside the real-time loop
+  datastore_ = &(const_cast<mc_control::MCController &>(ctl)).datastore();
+  if(datastore_->has(name() + "::ContactEvents")) { datastore_->remove(name() + "::ContactEvents"); }
+  datastore_->make_call(name() + "::ContactEvents", [this]() -> const measurements::ContactEvents &
+                        { return odometryManager_.contactsManager().contactEvents(); });
 }
 
 void TiltObserver::reset(const mc_control::MCController & ctl)
@@ -132,13 +160,33 @@ void TiltObserver::reset(const mc_control::MCController & ctl)
   const auto & realRobot = ctl.realRobot(robot_);
 
   my_robots_ = mc_rbdyn::Robots::make();
+#ifndef MC_STATE_OBSERVATION_HEADLESS
+  // robot displaying the estimation (only a visual feature)
   my_robots_->robotCopy(robot, robot.name());
+#endif
 
   // the updated robot has the same floating base's pose than the control robot, but its encoders are updated. We use it
   // to get more accurate local Kinematics.
   my_robots_->robotCopy(robot, "updatedRobot");
+  kinematicsCache_ = &pipeline::KinematicsCache::get(ctl);
+  if(partialKinematics_)
+  {
+    // without odometry, only the kinematics of the parent body of the IMU and of the bodies of the anchor frame are
+    // used
+    std::vector<std::string> bodies = anchorFrameBodies_;
+    bodies.push_back(robot.bodySensor(imuSensor_).parentBody());
+    for(const auto & surface : {"LeftFootCenter", "RightFootCenter"})
+    {
+      if(robot.hasSurface(surface)) { bodies.push_back(robot.surface(surface).bodyName()); }
+    }
+    kinematicChains_.init(robot.mb(), bodies);
+    mc_rtc::log::info("[{}]: {} joints out of {} are updated without odometry", name(), kinematicChains_.nrJoints(),
+                      robot.mb().nrJoints());
+  }
+#ifndef MC_STATE_OBSERVATION_HEADLESS
   ctl.gui()->addElement(
       {"Robots"}, mc_rtc::gui::Robot(name(), [this]() -> const mc_rbdyn::Robot & { return my_robots_->robot(); }));
+#endif
 
   const auto & imu = robot.bodySensor(imuSensor_);
 
@@ -168,6 +216,54 @@ void TiltObserver::reset(const mc_control::MCController & ctl)
   iter_ = 0;
   imuVelC_ = sva::MotionVecd::Zero();
   X_C_IMU_ = sva::PTransformd::Identity();
+  finalGainsReached_ = false;
+
+  if(checkpointFile_.empty()) { return; }
+  if(auto checkpoint = checkpoint::Checkpoint::tryLoad(checkpointFile_, name()))
+  {
+    if(!restoreState(*checkpoint, name()))
+    {
+      mc_rtc::log::warning("[{}]: the checkpoint doesn't match the configuration of the observer, cold start", name());
+    }
+  }
+}
+
+void TiltObserver::saveState(checkpoint::Checkpoint & checkpoint, const std::string & prefix) const
+{
+  checkpoint.set(prefix + "::x", xk_);
+  checkpoint.set(prefix + "::gains", Eigen::Vector3d(alpha_, beta_, gamma_));
+  checkpoint.set(prefix + "::finalGainsReached", finalGainsReached_ ? 1.0 : 0.0);
+  Eigen::Matrix<double, 7, 1> fbPose;
+  fbPose << poseW_.translation(), Eigen::Quaterniond(poseW_.rotation()).coeffs();
+  checkpoint.set(prefix + "::fbPose", fbPose);
+}
+
+bool TiltObserver::restoreState(const checkpoint::Checkpoint & checkpoint, const std::string & prefix)
+{
+  Eigen::Matrix<double, 9, 1> x;
+  Eigen::Vector3d gains;
+  double finalGainsReached = 0.0;
+  Eigen::Matrix<double, 7, 1> fbPose;
+  if(!checkpoint.get(prefix + "::x", x) || !checkpoint.get(prefix + "::gains", gains)
+     || !checkpoint.get(prefix + "::finalGainsReached", finalGainsReached)
+     || !checkpoint.get(prefix + "::fbPose", fbPose))
+  {
+    return false;
+  }
+
+  // the estimated velocity and tilt are restored, which skips the convergence of the estimator
+  estimator_.initEstimator(x.segment<3>(0), x.segment<3>(3), x.segment<3>(6));
+  xk_ = x;
+  alpha_ = gains(0);
+  beta_ = gains(1);
+  gamma_ = gains(2);
+  finalGainsReached_ = finalGainsReached > 0.5;
+
+  // the position and yaw of the floating base are kept from the previous run, the tilt is given by the estimator
+  poseW_ = sva::PTransformd(Eigen::Quaterniond(fbPose.tail<4>()).normalized().toRotationMatrix(), fbPose.head<3>());
+  if(odometryManager_.odometryType_ != measurements::OdometryType::None) { odometryManager_.replaceRobotPose(poseW_); }
+
+  return true;
 }
 
 bool TiltObserver::run(const mc_control::MCController & ctl)
@@ -176,8 +272,9 @@ bool TiltObserver::run(const mc_control::MCController & ctl)
   const auto & realRobot = ctl.realRobot(robot_);
   auto & logger = (const_cast<mc_control::MCController &>(ctl)).logger();
 
-  if(logger.t() > 1.0)
+  if(finalGainsReached_ || logger.t() > 1.0)
   {
+    finalGainsReached_ = true;
     alpha_ = finalAlpha_;
     beta_ = finalBeta_;
     gamma_ = finalGamma_;
@@ -187,19 +284,15 @@ bool TiltObserver::run(const mc_control::MCController & ctl)
   {
     const auto & robot = ctl.robot(robot_);
 
-    const auto & realQ = realRobot.mbc().q;
-    const auto & realAlpha = realRobot.mbc().alpha;
-
-    std::copy(std::next(realQ.begin()), realQ.end(), std::next(my_robots_->robot("updatedRobot").mbc().q.begin()));
-    std::copy(std::next(realAlpha.begin()), realAlpha.end(),
-              std::next(my_robots_->robot("updatedRobot").mbc().alpha.begin()));
-    my_robots_->robot("updatedRobot").mbc().q[0] = robot.mbc().q[0];
-    my_robots_->robot("updatedRobot").mbc().alpha[0] = robot.mbc().alpha[0];
+    auto & updatedRobot = my_robots_->robot("updatedRobot");
+    updatedRobot.mbc().q[0] = robot.mbc().q[0];
+    updatedRobot.mbc().alpha[0] = robot.mbc().alpha[0];
+    // the joints are copied from the real robot. Either only the chains we need are updated, or the kinematics of the
+    // whole robot are shared with the other observers of the pipeline
+    if(partialKinematics_) { kinematicChains_.update(updatedRobot, realRobot); }
+    else { kinematicsCache_->update(updatedRobot, realRobot, pipeline::KinematicsCache::Level::Velocity); }
 
-    my_robots_->robot("updatedRobot").forwardKinematics();
-    my_robots_->robot("updatedRobot").forwardVelocity();
-
-    runTiltEstimator(ctl, my_robots_->robot("updatedRobot"));
+    runTiltEstimator(ctl, updatedRobot);
   }
   else
   {
@@ -209,9 +302,11 @@ bool TiltObserver::run(const mc_control::MCController & ctl)
 
   iter_++;
 
+#ifndef MC_STATE_OBSERVATION_HEADLESS
   /* Update of the observed robot */
   my_robots_->robot().mbc().q = realRobot.mbc().q;
   update(my_robots_->robot());
+#endif
 
   return true;
 }
@@ -402,15 +497,20 @@ void TiltObserver::runTiltEstimator(const mc_control::MCController & ctl, const
       yv_ = -imu.angularVelocity().cross(imuAnchorKine_.position()) - imuAnchorKine_.linVel();
     }
   }
-  estimator_.setMeasurement(yv_, imu.linearAcceleration(), imu.angularVelocity(), k + 1);
   yk_.segment(0, 3) = yv_;
   yk_.segment(3, 3) = imu.linearAcceleration();
   yk_.segment(6, 3) = imu.angularVelocity();
 
-  if(odometryManager_.anchorPointMethodChanged_) { estimator_.resetImuLocVelHat(); }
+  {
+    // the allocations made by the estimator of the state-observation library are not under our control
+    profiling::allocations::ExternalCodeScope externalCode;
+    estimator_.setMeasurement(yv_, imu.linearAcceleration(), imu.angularVelocity(), k + 1);
+
+    if(odometryManager_.anchorPointMethodChanged_) { estimator_.resetImuLocVelHat(); }
 
-  // estimation of the state with the complementary filters
-  xk_ = estimator_.getEstimatedState(k + 1);
+    // estimation of the state with the complementary filters
+    xk_ = estimator_.getEstimatedState(k + 1);
+  }
 
   // retrieving the estimated Tilt
   so::Vector3 tilt = xk_.tail(3);
@@ -512,37 +612,31 @@ void TiltObserver::update(mc_rbdyn::Robot & robot)
   robot.velW(velW_);
 }
 
-const so::kine::Kinematics TiltObserver::backupFb(boost::circular_buffer<so::kine::Kinematics> * koBackupFbKinematics)
+const so::kine::Kinematics TiltObserver::backupFb(backup::FbKinematicsHistory * koBackupFbKinematics)
 {
   // new initial pose of the floating base
-  so::kine::Kinematics worldResetKine = *(koBackupFbKinematics->begin());
+  so::kine::Kinematics worldResetKine = koBackupFbKinematics->front();
 
   // original initial pose of the floating base
-  so::kine::Kinematics worldFbInitBackup = backupFbKinematics_.front();
+  const so::kine::Kinematics worldFbInitBackup = backupFbKinematics_.front();
 
   so::kine::Kinematics fbWorldInitBackup = worldFbInitBackup.getInverse();
 
   // we apply the transformation from the initial pose to the intermediates pose estimated by the tilt estimator to the
-  // new starting pose of the Kinetics Observer
-  for(int i = 0; i < koBackupFbKinematics->size(); i++)
-  {
-    // Intermediary pose of the floating base estimated by the tilt estimator
-    so::kine::Kinematics worldFbIntermBackup = backupFbKinematics_.at(i);
-
-    // transformation between the initial and the intermediary pose during the backup interval
-    so::kine::Kinematics initInterm = fbWorldInitBackup * worldFbIntermBackup;
-
-    koBackupFbKinematics->at(i) = worldResetKine * initInterm;
-  }
+  // new starting pose of the Kinetics Observer. This transformation is the same for all the poses, so the history only
+  // stores it and applies it when a pose is read.
+  koBackupFbKinematics->reanchor(worldResetKine * fbWorldInitBackup, backupFbKinematics_);
 
   so::Vector3 tiltLocalLinVel = poseW_.rotation() * velW_.linear();
   so::Vector3 tiltLocalAngVel = poseW_.rotation() * velW_.angular();
 
   // koBackupFbKinematics->back() is the new last pose of the kinetics observer
-  koBackupFbKinematics->back().linVel = koBackupFbKinematics->back().orientation.toMatrix3() * tiltLocalLinVel;
-  koBackupFbKinematics->back().angVel = koBackupFbKinematics->back().orientation.toMatrix3() * tiltLocalAngVel;
+  so::kine::Kinematics worldFbKine = koBackupFbKinematics->back();
+  worldFbKine.linVel = worldFbKine.orientation.toMatrix3() * tiltLocalLinVel;
+  worldFbKine.angVel = worldFbKine.orientation.toMatrix3() * tiltLocalAngVel;
+  koBackupFbKinematics->setBack(worldFbKine);
 
-  return koBackupFbKinematics->back();
+  return worldFbKine;
 }
 
 so::kine::Kinematics TiltObserver::applyLastTransformation(const so::kine::Kinematics & previousKine)
@@ -578,7 +672,7 @@ void TiltObserver::addToLogger(const mc_control::MCController & ctl,
   category_ = category;
   if(odometryManager_.odometryType_ != measurements::OdometryType::None)
   {
-    odometryManager_.addToLogger(logger, category + "_leggedOdometryManager");
+    odometryManager_.addToLogger(ctl, logger, category + "_leggedOdometryManager");
   }
 
   logger.addLogEntry(category + "_estimatedState_x1", [this]() -> so::Vector3 { return xk_.head(3); });
@@ -852,6 +946,11 @@ void TiltObserver::addToGUI(const mc_control::MCController &,
                             mc_rtc::gui::StateBuilder & gui,
                             const std::vector<std::string> & category)
 {
+#ifdef MC_STATE_OBSERVATION_HEADLESS
+  // no GUI is attached to the headless builds
+  (void)gui;
+  (void)category;
+#else
   using namespace mc_state_observation::gui;
   gui.addElement(category, make_input_element("alpha", alpha_), make_input_element("beta", beta_),
                  make_input_element("gamma", gamma_));
@@ -863,6 +962,7 @@ void TiltObserver::addToGUI(const mc_control::MCController &,
     std::vector<std::string> odomCategory = category;
     odomCategory.insert(odomCategory.end(), {"Odometry"});
   }
+#endif
 }
 
 } // namespace mc_state_observation
@@ -0,0 +1,43 @@
+#include <mc_state_observation/backup/FbKinematicsHistory.h>
+
+#include <algorithm>
+
+namespace mc_state_observation::backup
+{
+
+void FbKinematicsHistory::set_capacity(size_t capacity)
+{
+  entries_.set_capacity(capacity);
+  reanchoredUntil_ = 0;
+  reference_ = nullptr;
+}
+
+void FbKinematicsHistory::push_back(const Kinematics & kine)
+{
+  entries_.push_back(kine);
+  ++nbPushed_;
+}
+
+FbKinematicsHistory::Kinematics FbKinematicsHistory::at(size_t i) const
+{
+  // number of entries added since the i-th oldest one, including it
+  const uint64_t age = entries_.size() - i;
+  if(nbPushed_ - age < reanchoredUntil_) { return anchor_ * reference_->at(i); }
+  return entries_.at(i);
+}
+
+void FbKinematicsHistory::setBack(const Kinematics & kine)
+{
+  entries_.setBack(kine);
+  // the newest entry is now given by the history itself
+  reanchoredUntil_ = std::min(reanchoredUntil_, nbPushed_ - 1);
+}
+
+void FbKinematicsHistory::reanchor(const Kinematics & anchor, const Reference & reference)
+{
+  anchor_ = anchor;
+  reference_ = &reference;
+  reanchoredUntil_ = nbPushed_;
+}
+
+} // namespace mc_state_observation::backup
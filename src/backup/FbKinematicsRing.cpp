@@ -0,0 +1,66 @@
+#include <mc_state_observation/backup/FbKinematicsRing.h>
+
+#include <stdexcept>
+
+namespace so = stateObservation;
+
+namespace mc_state_observation::backup
+{
+
+void FbKinematicsRing::set_capacity(size_t capacity)
+{
+  const auto cols = static_cast<Eigen::Index>(capacity);
+  orientations_.resize(4, cols);
+  positions_.resize(3, cols);
+  if(withVelocities_)
+  {
+    linVels_.resize(3, cols);
+    angVels_.resize(3, cols);
+  }
+  first_ = 0;
+  size_ = 0;
+}
+
+void FbKinematicsRing::push_back(const Kinematics & kine)
+{
+  if(capacity() == 0) { return; }
+  if(size_ < capacity()) { ++size_; }
+  else { first_ = (first_ + 1) % capacity(); }
+  store(index(size_ - 1), kine);
+}
+
+FbKinematicsRing::Kinematics FbKinematicsRing::at(size_t i) const
+{
+  if(i >= size_) { throw std::out_of_range("FbKinematicsRing::at: index out of range"); }
+  const Eigen::Index j = index(i);
+
+  Kinematics kine;
+  kine.position = so::Vector3(positions_.col(j));
+  kine.orientation = so::Quaternion(so::Vector4(orientations_.col(j)));
+  if(withVelocities_)
+  {
+    kine.linVel = so::Vector3(linVels_.col(j));
+    kine.angVel = so::Vector3(angVels_.col(j));
+  }
+  return kine;
+}
+
+void FbKinematicsRing::setBack(const Kinematics & kine)
+{
+  // also the case of a buffer without capacity, in which no entry can be added
+  if(size_ == 0) { throw std::out_of_range("FbKinematicsRing::setBack: the buffer is empty"); }
+  store(index(size_ - 1), kine);
+}
+
+void FbKinematicsRing::store(Eigen::Index index, const Kinematics & kine)
+{
+  positions_.col(index) = kine.position();
+  orientations_.col(index) = kine.orientation.toQuaternion().coeffs();
+  if(withVelocities_)
+  {
+    linVels_.col(index) = kine.linVel.isSet() ? kine.linVel() : so::Vector3::Zero();
+    angVels_.col(index) = kine.angVel.isSet() ? kine.angVel() : so::Vector3::Zero();
+  }
+}
+
+} // namespace mc_state_observation::backup
@@ -0,0 +1,144 @@
+#include <mc_rtc/logging.h>
+
+#include <mc_state_observation/checkpoint/Checkpoint.h>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+namespace mc_state_observation::checkpoint
+{
+
+namespace
+{
+// identifies the checkpoint files
+constexpr char magic[8] = {'M', 'C', 'S', 'O', 'C', 'K', 'P', 'T'};
+// incremented on each change of the layout of the file
+constexpr uint32_t version = 1;
+
+template<typename T>
+void write(std::ofstream & file, const T & value)
+{
+  file.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template<typename T>
+T read(std::ifstream & file)
+{
+  T value;
+  file.read(reinterpret_cast<char *>(&value), sizeof(T));
+  return value;
+}
+} // namespace
+
+void Checkpoint::set(const std::string & key, const Eigen::Ref<const Eigen::MatrixXd> & value)
+{
+  entries_[key] = value;
+}
+
+std::vector<std::string> Checkpoint::keys(const std::string & prefix) const
+{
+  std::vector<std::string> keys;
+  // the entries are sorted by name, so the ones with the prefix are contiguous
+  for(auto it = entries_.lower_bound(prefix); it != entries_.end() && it->first.compare(0, prefix.size(), prefix) == 0;
+      ++it)
+  {
+    keys.push_back(it->first.substr(prefix.size()));
+  }
+  return keys;
+}
+
+bool Checkpoint::get(const std::string & key, double & value) const
+{
+  Eigen::Matrix<double, 1, 1> scalar;
+  if(!get(key, scalar)) { return false; }
+  value = scalar(0);
+  return true;
+}
+
+void Checkpoint::save(const std::string & path) const
+{
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if(!file) { mc_rtc::log::error_and_throw<std::runtime_error>("Cannot write the checkpoint file {}", path); }
+
+  file.write(magic, sizeof(magic));
+  write(file, version);
+  write(file, static_cast<uint32_t>(entries_.size()));
+  for(const auto & [key, value] : entries_)
+  {
+    write(file, static_cast<uint32_t>(key.size()));
+    file.write(key.data(), static_cast<std::streamsize>(key.size()));
+    write(file, static_cast<uint32_t>(value.rows()));
+    write(file, static_cast<uint32_t>(value.cols()));
+    file.write(reinterpret_cast<const char *>(value.data()),
+               static_cast<std::streamsize>(sizeof(double) * static_cast<size_t>(value.size())));
+  }
+  if(!file) { mc_rtc::log::error_and_throw<std::runtime_error>("Failed to write the checkpoint file {}", path); }
+}
+
+Checkpoint Checkpoint::load(const std::string & path)
+{
+  std::ifstream file(path, std::ios::binary);
+  if(!file) { mc_rtc::log::error_and_throw<std::runtime_error>("Cannot read the checkpoint file {}", path); }
+
+  char fileMagic[sizeof(magic)];
+  file.read(fileMagic, sizeof(fileMagic));
+  if(!file || std::memcmp(fileMagic, magic, sizeof(magic)) != 0 || read<uint32_t>(file) != version)
+  {
+    mc_rtc::log::error_and_throw<std::runtime_error>("{} is not a checkpoint file of this version", path);
+  }
+
+  Checkpoint checkpoint;
+  const uint32_t nbEntries = read<uint32_t>(file);
+  for(uint32_t i = 0; i < nbEntries && file; ++i)
+  {
+    std::string key(read<uint32_t>(file), '\0');
+    file.read(key.data(), static_cast<std::streamsize>(key.size()));
+    const uint32_t rows = read<uint32_t>(file);
+    const uint32_t cols = read<uint32_t>(file);
+    if(!file) { break; }
+    Eigen::MatrixXd value(rows, cols);
+    file.read(reinterpret_cast<char *>(value.data()),
+              static_cast<std::streamsize>(sizeof(double) * static_cast<size_t>(value.size())));
+    checkpoint.entries_[key] = std::move(value);
+  }
+  if(!file) { mc_rtc::log::error_and_throw<std::runtime_error>("The checkpoint file {} is truncated", path); }
+  return checkpoint;
+}
+
+bool Checkpoint::trySave(const std::string & path, const std::string & observerName) const noexcept
+{
+  try
+  {
+    save(path);
+    mc_rtc::log::info("[{}]: state saved in the checkpoint file {}", observerName, path);
+    return true;
+  }
+  catch(const std::exception & e)
+  {
+    mc_rtc::log::warning("[{}]: the state could not be saved: {}", observerName, e.what());
+    return false;
+  }
+}
+
+std::optional<Checkpoint> Checkpoint::tryLoad(const std::string & path, const std::string & observerName)
+{
+  if(!std::ifstream(path).good())
+  {
+    mc_rtc::log::info("[{}]: no checkpoint file {}, cold start", observerName, path);
+    return std::nullopt;
+  }
+  try
+  {
+    Checkpoint checkpoint = load(path);
+    mc_rtc::log::info("[{}]: warm start from the checkpoint file {}", observerName, path);
+    return checkpoint;
+  }
+  catch(const std::exception & e)
+  {
+    mc_rtc::log::warning("[{}]: {}, cold start", observerName, e.what());
+    return std::nullopt;
+  }
+}
+
+} // namespace mc_state_observation::checkpoint
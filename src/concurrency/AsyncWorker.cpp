@@ -0,0 +1,52 @@
+#include <mc_state_observation/concurrency/AsyncWorker.h>
+
+namespace mc_state_observation::concurrency
+{
+
+AsyncWorker::AsyncWorker(std::function<void()> job) : job_(std::move(job))
+{
+  thread_ = std::thread([this]() { loop(); });
+}
+
+AsyncWorker::~AsyncWorker()
+{
+  wait();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  condition_.notify_one();
+  thread_.join();
+}
+
+void AsyncWorker::trigger()
+{
+  {
+    // the lock is never contended: the worker holds it only while it is not running any job
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.store(true, std::memory_order_release);
+  }
+  condition_.notify_one();
+}
+
+void AsyncWorker::wait() const noexcept
+{
+  // the job is triggered one iteration before we wait for it, so we only spin if it overran the iteration
+  while(pending_.load(std::memory_order_acquire)) { std::this_thread::yield(); }
+}
+
+void AsyncWorker::loop()
+{
+  while(true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      condition_.wait(lock, [this]() { return stop_ || pending_.load(std::memory_order_acquire); });
+      if(stop_) { return; }
+    }
+    job_();
+    pending_.store(false, std::memory_order_release);
+  }
+}
+
+} // namespace mc_state_observation::concurrency
@@ -4,6 +4,8 @@
 
 #include <mc_state_observation/odometry/LeggedOdometryManager.h>
 
+#include <algorithm>
+
 namespace so = stateObservation;
 
 namespace mc_state_observation::odometry
@@ -28,10 +30,18 @@ void LeggedOdometryManager::init(const mc_control::MCController & ctl,
 
   odometryRobot_ = mc_rbdyn::Robots::make();
   odometryRobot_->robotCopy(robot, "odometryRobot");
+  kinematicsCache_ = &pipeline::KinematicsCache::get(ctl);
 
   odometryType_ = odomConfig.odometryType_;
   withYawEstimation_ = odomConfig.withYaw_;
+  if(odomConfig.maxOriContacts_ == 0)
+  {
+    mc_rtc::log::error_and_throw<std::runtime_error>(
+        "[{}]: At least one contact must be used for the orientation odometry", odomConfig.odometryName_);
+  }
+  contactsManager_.maxOriOdometryContacts(odomConfig.maxOriContacts_);
   correctContacts_ = odomConfig.correctContacts_;
+  withPreRegisteredContactLogs_ = odomConfig.withPreRegisteredContactLogs_;
   velocityUpdate_ = odomConfig.velocityUpdate_;
   odometryName_ = odomConfig.odometryName_;
 
@@ -96,17 +106,8 @@ void LeggedOdometryManager::reset()
 
 void LeggedOdometryManager::updateJointsConfiguration(const mc_control::MCController & ctl)
 {
-  const auto & realRobot = ctl.realRobot(robotName_);
-
-  // Copy the real configuration except for the floating base
-  const auto & realQ = realRobot.mbc().q;
-  const auto & realAlpha = realRobot.mbc().alpha;
-
-  std::copy(std::next(realQ.begin()), realQ.end(), std::next(odometryRobot().mbc().q.begin()));
-  std::copy(std::next(realAlpha.begin()), realAlpha.end(), std::next(odometryRobot().mbc().alpha.begin()));
-
-  odometryRobot().forwardKinematics();
-  odometryRobot().forwardVelocity();
+  // Copy the real configuration except for the floating base, the kinematics being shared with the other observers
+  kinematicsCache_->update(odometryRobot(), ctl.realRobot(robotName_), pipeline::KinematicsCache::Level::Velocity);
 }
 
 void LeggedOdometryManager::run(const mc_control::MCController & ctl, KineParams & kineParams)
@@ -153,38 +154,44 @@ void LeggedOdometryManager::updateFbAndContacts(const mc_control::MCController &
     // we update the orientation of the floating base first
     if(oriUpdatable)
     {
-      // the orientation can be updated using contacts, it will use at most the two most suitable contacts.
-      // We merge the obtained yaw with the tilt estimated by the previous observers
-      if(contactsManager_.oriOdometryContacts_.size() == 1)
+      // the orientation can be updated using contacts, it will use at most the maxOriOdometryContacts most suitable
+      // contacts. We merge the obtained yaw with the tilt estimated by the previous observers
+      const auto & oriOdometryContacts = contactsManager_.oriOdometryContacts_;
+      if(oriOdometryContacts.size() == 1)
       {
         // the orientation can be updated using 1 contact
         fbKine_.orientation = stateObservation::kine::mergeRoll1Pitch1WithYaw2AxisAgnostic(
-            tilt, contactsManager_.oriOdometryContacts_.begin()->get().worldFbKineFromRef_.orientation);
+            tilt, oriOdometryContacts.front()->worldFbKineFromRef_.orientation);
       }
-      if(contactsManager_.oriOdometryContacts_.size() == 2) // the orientation can be updated using 2 contacts
+      else // the orientation can be updated using several contacts
       {
-        const auto & contact1 = (*contactsManager_.oriOdometryContacts_.begin()).get();
-        const auto & contact2 = (*std::next(contactsManager_.oriOdometryContacts_.begin(), 1)).get();
-
-        const auto & R1 = contact1.worldFbKineFromRef_.orientation.toMatrix3();
-        const auto & R2 = contact2.worldFbKineFromRef_.orientation.toMatrix3();
+        // the orientations obtained from each contact are averaged one after the other, weighted by their force
+        stateObservation::Matrix3 meanOri = oriOdometryContacts.front()->worldFbKineFromRef_.orientation.toMatrix3();
+        double sumForces = oriOdometryContacts.front()->forceNorm();
+        for(size_t i = 1; i < oriOdometryContacts.size(); ++i)
+        {
+          const auto & contact = *oriOdometryContacts[i];
+          const auto & R2 = contact.worldFbKineFromRef_.orientation.toMatrix3();
 
-        double u = contact1.forceNorm() / sumForces_orientation;
+          sumForces += contact.forceNorm();
+          double u = (sumForces - contact.forceNorm()) / sumForces;
 
-        stateObservation::Matrix3 diffRot = R1.transpose() * R2;
+          stateObservation::Matrix3 diffRot = meanOri.transpose() * R2;
 
-        stateObservation::Vector3 diffRotVector =
-            (1.0 - u)
-            * stateObservation::kine::skewSymmetricToRotationVector(
-                diffRot); // we perform the multiplication by the weighting coefficient now so a
-                          // zero coefficient gives a unit rotation matrix and not a zero matrix
+          stateObservation::Vector3 diffRotVector =
+              (1.0 - u)
+              * stateObservation::kine::skewSymmetricToRotationVector(
+                  diffRot); // we perform the multiplication by the weighting coefficient now so a
+                            // zero coefficient gives a unit rotation matrix and not a zero matrix
 
-        stateObservation::AngleAxis diffRotAngleAxis = stateObservation::kine::rotationVectorToAngleAxis(diffRotVector);
+          stateObservation::AngleAxis diffRotAngleAxis =
+              stateObservation::kine::rotationVectorToAngleAxis(diffRotVector);
 
-        stateObservation::Matrix3 diffRotMatrix =
-            stateObservation::kine::Orientation(diffRotAngleAxis).toMatrix3(); // exp( (1 - u) * log(R1^T R2) )
+          stateObservation::Matrix3 diffRotMatrix =
+              stateObservation::kine::Orientation(diffRotAngleAxis).toMatrix3(); // exp( (1 - u) * log(R1^T R2) )
 
-        stateObservation::Matrix3 meanOri = R1 * diffRotMatrix;
+          meanOri = meanOri * diffRotMatrix;
+        }
         fbKine_.orientation = stateObservation::kine::mergeRoll1Pitch1WithYaw2AxisAgnostic(tilt, meanOri);
       }
     }
@@ -238,6 +245,38 @@ void LeggedOdometryManager::updateFbAndContacts(const mc_control::MCController &
   for(auto * nContact : newContacts_) { setNewContact(*nContact, robot); }
 }
 
+void LeggedOdometryManager::LeggedOdometryContactsManager::maxOriOdometryContacts(size_t maxOriOdometryContacts)
+{
+  maxOriOdometryContacts_ = maxOriOdometryContacts;
+  oriOdometryContacts_.clear();
+  oriOdometryContacts_.reserve(maxOriOdometryContacts_);
+}
+
+void LeggedOdometryManager::LeggedOdometryContactsManager::selectForOrientation(LoContactWithSensor & contact)
+{
+  // the list is full and the contact has a lower force than all the selected ones
+  if(oriOdometryContacts_.size() == maxOriOdometryContacts_
+     && contact.forceNorm() <= oriOdometryContacts_.front()->forceNorm())
+  {
+    contact.useForOrientation_ = false;
+    return;
+  }
+
+  // we remove the contact with the lowest force to make room for the new one
+  if(oriOdometryContacts_.size() == maxOriOdometryContacts_)
+  {
+    oriOdometryContacts_.front()->useForOrientation_ = false;
+    oriOdometryContacts_.erase(oriOdometryContacts_.begin());
+  }
+
+  // the list is sorted from the lowest to the highest force
+  auto it = std::upper_bound(oriOdometryContacts_.begin(), oriOdometryContacts_.end(), contact.forceNorm(),
+                             [](double forceNorm, const LoContactWithSensor * selectedContact)
+                             { return forceNorm < selectedContact->forceNorm(); });
+  oriOdometryContacts_.insert(it, &contact);
+  contact.useForOrientation_ = true;
+}
+
 void LeggedOdometryManager::selectForOrientationOdometry(bool & oriUpdatable, double & sumForcesOrientation)
 {
   // we cannot update the orientation if no contact was set on last iteration
@@ -252,22 +291,15 @@ void LeggedOdometryManager::selectForOrientationOdometry(bool & oriUpdatable, do
       if(mContact->name().find("Hand") == std::string::npos && mContact->isSet()
          && mContact->wasAlreadySet()) // we don't use hands for the orientation odometry
       {
-        mContact->useForOrientation_ = true;
-        contactsManager_.oriOdometryContacts_.insert(*mContact);
+        contactsManager_.selectForOrientation(*mContact);
       }
     }
 
-    // contacts are sorted from the lowest force to the highest force
-    while(contactsManager_.oriOdometryContacts_.size() > 2)
-    {
-      (*contactsManager_.oriOdometryContacts_.begin()).get().useForOrientation_ = false;
-      contactsManager_.oriOdometryContacts_.erase(contactsManager_.oriOdometryContacts_.begin());
-    }
-
     // the position of the floating base in the world can be obtained by a weighted average of the estimations for each
     // contact
-    for(LoContactWithSensor & oriOdomContact : contactsManager_.oriOdometryContacts_)
+    for(LoContactWithSensor * oriOdomContactPtr : contactsManager_.oriOdometryContacts_)
     {
+      LoContactWithSensor & oriOdomContact = *oriOdomContactPtr;
       // the orientation can be computed using contacts
       oriUpdatable = true;
 
@@ -470,7 +502,7 @@ void LeggedOdometryManager::setNewContact(LoContactWithSensor & contact, const m
 {
   contact.resetLifeTime();
 
-  const mc_rbdyn::ForceSensor & forceSensor = measurementsRobot.forceSensor(contact.forceSensor());
+  const mc_rbdyn::ForceSensor & forceSensor = measurementsRobot.forceSensors()[contact.forceSensorIndex()];
   // If the contact is not detected using surfaces, we must consider that the frame of the sensor is the one of the
   // surface).
 
@@ -826,7 +858,9 @@ void LeggedOdometryManager::setOdometryType(OdometryType newOdometryType)
   }
 }
 
-void LeggedOdometryManager::addToLogger(mc_rtc::Logger & logger, const std::string & leggedOdomCategory)
+void LeggedOdometryManager::addToLogger(const mc_control::MCController & ctl,
+                                        mc_rtc::Logger & logger,
+                                        const std::string & leggedOdomCategory)
 {
   category_ = leggedOdomCategory;
   logger.addLogEntry(leggedOdomCategory + "_fbAnchorPos_", [this]() -> so::Vector3 & { return fbAnchorPos_; });
@@ -844,6 +878,12 @@ void LeggedOdometryManager::addToLogger(mc_rtc::Logger & logger, const std::stri
                      [this]() -> std::string { return measurements::odometryTypeToSstring(odometryType_); });
 
   contactsManager_.addToLogger(logger, leggedOdomCategory + "_contactsManager");
+
+  // the entries of the contacts added to the manager later are registered by initContacts
+  if(withPreRegisteredContactLogs_)
+  {
+    for(const auto & contact : contactsManager_.contacts()) { addContactLogEntries(ctl, logger, contact); }
+  }
 }
 
 } // namespace mc_state_observation::odometry
@@ -0,0 +1,75 @@
+#include <mc_rtc/logging.h>
+
+#include <mc_state_observation/pipeline/KinematicChains.h>
+
+namespace mc_state_observation::pipeline
+{
+
+void KinematicChains::init(const rbd::MultiBody & mb, const std::vector<std::string> & bodies)
+{
+  // index of the joint leading to each body
+  std::vector<int> bodyJoint(static_cast<size_t>(mb.nrBodies()), -1);
+  for(int j = 0; j < mb.nrJoints(); ++j) { bodyJoint[static_cast<size_t>(mb.successor(j))] = j; }
+
+  std::vector<bool> selected(static_cast<size_t>(mb.nrJoints()), false);
+  for(const auto & body : bodies)
+  {
+    if(!mb.bodyIndexByName().count(body))
+    {
+      mc_rtc::log::error_and_throw<std::runtime_error>("The body {} required by the kinematic chains does not exist",
+                                                       body);
+    }
+    // we go up the tree until the root or an already selected joint
+    int j = bodyJoint[static_cast<size_t>(mb.bodyIndexByName(body))];
+    while(j != -1 && !selected[static_cast<size_t>(j)])
+    {
+      selected[static_cast<size_t>(j)] = true;
+      const int pred = mb.predecessor(j);
+      j = (pred == -1) ? -1 : bodyJoint[static_cast<size_t>(pred)];
+    }
+  }
+
+  joints_.clear();
+  // the joints of a multibody are sorted from the root to the leaves
+  for(int j = 0; j < mb.nrJoints(); ++j)
+  {
+    if(selected[static_cast<size_t>(j)]) { joints_.push_back(j); }
+  }
+}
+
+void KinematicChains::update(mc_rbdyn::Robot & robot, const mc_rbdyn::Robot & source) const
+{
+  const auto & mb = robot.mb();
+  auto & mbc = robot.mbc();
+  const auto & sourceMbc = source.mbc();
+
+  for(int j : joints_)
+  {
+    const size_t i = static_cast<size_t>(j);
+    const int pred = mb.predecessor(j);
+    const size_t succ = static_cast<size_t>(mb.successor(j));
+    if(pred != -1)
+    {
+      mbc.q[i] = sourceMbc.q[i];
+      mbc.alpha[i] = sourceMbc.alpha[i];
+    }
+
+    // same computations as rbd::forwardKinematics and rbd::forwardVelocity, restricted to the joints of the chains
+    mbc.jointConfig[i] = mb.joint(j).pose(mbc.q[i]);
+    mbc.parentToSon[i] = mbc.jointConfig[i] * mb.transform(j);
+    mbc.jointVelocity[i] = mb.joint(j).motion(mbc.alpha[i]);
+    if(pred != -1)
+    {
+      mbc.bodyPosW[succ] = mbc.parentToSon[i] * mbc.bodyPosW[static_cast<size_t>(pred)];
+      mbc.bodyVelB[succ] = mbc.parentToSon[i] * mbc.bodyVelB[static_cast<size_t>(pred)] + mbc.jointVelocity[i];
+    }
+    else
+    {
+      mbc.bodyPosW[succ] = mbc.parentToSon[i];
+      mbc.bodyVelB[succ] = mbc.jointVelocity[i];
+    }
+    mbc.bodyVelW[succ] = sva::PTransformd(mbc.bodyPosW[succ].rotation()).invMul(mbc.bodyVelB[succ]);
+  }
+}
+
+} // namespace mc_state_observation::pipeline
@@ -0,0 +1,151 @@
+#include <mc_state_observation/pipeline/KinematicsCache.h>
+
+#include <RBDyn/FA.h>
+#include <RBDyn/FK.h>
+#include <RBDyn/FV.h>
+
+namespace mc_state_observation::pipeline
+{
+
+namespace
+{
+/// @brief Copies the configuration of the joints from the source vector into the target one, except for the floating
+/// base. Returns true if the target changed.
+bool copyJoints(std::vector<std::vector<double>> & target, const std::vector<std::vector<double>> & source)
+{
+  bool changed = false;
+  for(size_t i = 1; i < source.size(); ++i)
+  {
+    if(target[i] != source[i])
+    {
+      target[i] = source[i];
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+/// @brief Returns true if all the values are zero, except the first one which must be one if firstIsOne is true (unit
+/// quaternion of the free joint).
+bool isZero(const std::vector<double> & values, bool firstIsOne)
+{
+  for(size_t i = 0; i < values.size(); ++i)
+  {
+    if(values[i] != ((i == 0 && firstIsOne) ? 1.0 : 0.0)) { return false; }
+  }
+  return true;
+}
+} // namespace
+
+KinematicsCache & KinematicsCache::get(const mc_control::MCController & ctl)
+{
+  auto & datastore = (const_cast<mc_control::MCController &>(ctl)).datastore();
+  const std::string key = ctl.observerPipeline().name() + "::KinematicsCache";
+  if(!datastore.has(key)) { return datastore.make<KinematicsCache>(key); }
+  return datastore.get<KinematicsCache>(key);
+}
+
+KinematicsCache::Entry & KinematicsCache::entry(const mc_rbdyn::Robot & source)
+{
+  auto it = entries_.find(source.name());
+  if(it != entries_.end()) { return it->second; }
+
+  // allocated only once per robot, on the first update
+  Entry & entry = entries_[source.name()];
+  entry.mb = source.mb();
+  entry.mbc = source.mbc();
+  entry.rootToBody.resize(entry.mb.nrBodies());
+
+  // we bring the floating base back to the origin of the world frame with zero velocity and acceleration
+  std::fill(entry.mbc.q[0].begin(), entry.mbc.q[0].end(), 0.0);
+  if(!entry.mbc.q[0].empty()) { entry.mbc.q[0][0] = 1.0; }
+  std::fill(entry.mbc.alpha[0].begin(), entry.mbc.alpha[0].end(), 0.0);
+  std::fill(entry.mbc.alphaD[0].begin(), entry.mbc.alphaD[0].end(), 0.0);
+  return entry;
+}
+
+void KinematicsCache::updateEntry(Entry & entry, const mc_rbdyn::Robot & source, Level level)
+{
+  const auto & sourceMbc = source.mbc();
+  if(copyJoints(entry.mbc.q, sourceMbc.q)) { entry.hasPosition = entry.hasVelocity = entry.hasAcceleration = false; }
+  if(level >= Level::Velocity && copyJoints(entry.mbc.alpha, sourceMbc.alpha))
+  {
+    entry.hasVelocity = entry.hasAcceleration = false;
+  }
+  if(level >= Level::Acceleration && copyJoints(entry.mbc.alphaD, sourceMbc.alphaD)) { entry.hasAcceleration = false; }
+
+  if(!entry.hasPosition)
+  {
+    rbd::forwardKinematics(entry.mb, entry.mbc);
+    const sva::PTransformd bodyToRoot = entry.mbc.bodyPosW[entry.mb.successor(0)].inv();
+    for(size_t b = 0; b < entry.rootToBody.size(); ++b) { entry.rootToBody[b] = entry.mbc.bodyPosW[b] * bodyToRoot; }
+    entry.hasPosition = true;
+  }
+  if(level >= Level::Velocity && !entry.hasVelocity)
+  {
+    rbd::forwardVelocity(entry.mb, entry.mbc);
+    entry.hasVelocity = true;
+  }
+  if(level >= Level::Acceleration && !entry.hasAcceleration)
+  {
+    rbd::forwardAcceleration(entry.mb, entry.mbc);
+    entry.hasAcceleration = true;
+  }
+}
+
+void KinematicsCache::update(mc_rbdyn::Robot & robot, const mc_rbdyn::Robot & source, Level level)
+{
+  Entry & entry = this->entry(source);
+  updateEntry(entry, source, level);
+
+  const auto & mb = robot.mb();
+  auto & mbc = robot.mbc();
+  const auto & cached = entry.mbc;
+
+  copyJoints(mbc.q, cached.q);
+  if(level >= Level::Velocity) { copyJoints(mbc.alpha, cached.alpha); }
+  if(level >= Level::Acceleration) { copyJoints(mbc.alphaD, cached.alphaD); }
+
+  const bool zeroPose = isZero(mbc.q[0], true);
+  const bool zeroVel = isZero(mbc.alpha[0], false);
+
+  // the poses of the bodies are given by the pose of the root body, which is the only one depending on the floating
+  // base
+  mbc.jointConfig = cached.jointConfig;
+  mbc.parentToSon = cached.parentToSon;
+  if(zeroPose) { mbc.bodyPosW = cached.bodyPosW; }
+  else
+  {
+    mbc.jointConfig[0] = mb.joint(0).pose(mbc.q[0]);
+    mbc.parentToSon[0] = mbc.jointConfig[0] * mb.transform(0);
+    for(size_t b = 0; b < mbc.bodyPosW.size(); ++b) { mbc.bodyPosW[b] = entry.rootToBody[b] * mbc.parentToSon[0]; }
+  }
+  if(level == Level::Position) { return; }
+
+  // the velocity of each body is the sum of the one given by the joints (the cached one) and of the velocity of the
+  // root body transported to the body
+  mbc.jointVelocity = cached.jointVelocity;
+  if(zeroVel) { mbc.bodyVelB = cached.bodyVelB; }
+  else
+  {
+    mbc.jointVelocity[0] = mb.joint(0).motion(mbc.alpha[0]);
+    for(size_t b = 0; b < mbc.bodyVelB.size(); ++b)
+    {
+      mbc.bodyVelB[b] = entry.rootToBody[b] * mbc.jointVelocity[0] + cached.bodyVelB[b];
+    }
+  }
+  if(zeroPose && zeroVel) { mbc.bodyVelW = cached.bodyVelW; }
+  else
+  {
+    for(size_t b = 0; b < mbc.bodyVelW.size(); ++b)
+    {
+      mbc.bodyVelW[b] = sva::PTransformd(mbc.bodyPosW[b].rotation()).invMul(mbc.bodyVelB[b]);
+    }
+  }
+  if(level == Level::Velocity) { return; }
+
+  if(zeroVel && isZero(mbc.alphaD[0], false)) { mbc.bodyAccB = cached.bodyAccB; }
+  else { rbd::forwardAcceleration(mb, mbc); }
+}
+
+} // namespace mc_state_observation::pipeline
@@ -0,0 +1,38 @@
+#include <mc_state_observation/profiling/AllocationTracking.h>
+
+namespace mc_state_observation::profiling::allocations
+{
+
+namespace
+{
+// the state is per thread so the allocations of the other threads (logger, GUI, ROS) are never counted
+thread_local bool trackingStarted = false;
+thread_local unsigned externalCodeDepth = 0;
+} // namespace
+
+void startTracking() noexcept
+{
+  trackingStarted = true;
+}
+
+void stopTracking() noexcept
+{
+  trackingStarted = false;
+}
+
+bool tracked() noexcept
+{
+  return trackingStarted && externalCodeDepth == 0;
+}
+
+ExternalCodeScope::ExternalCodeScope() noexcept
+{
+  ++externalCodeDepth;
+}
+
+ExternalCodeScope::~ExternalCodeScope()
+{
+  --externalCodeDepth;
+}
+
+} // namespace mc_state_observation::profiling::allocations
@@ -0,0 +1,143 @@
+/**
+ * Benchmark of the computation time of the backup of the Kinetics Observer on the iteration where it is reset.
+ *
+ * On a reset, the history of the floating base estimated by the Kinetics Observer over the backup interval is replaced
+ * by the one of its backup observer, re-anchored on the oldest pose of the history. This benchmark compares the
+ * re-anchoring of each entry of the history (previous implementation) with the constant time re-anchoring of
+ * backup::FbKinematicsHistory, for the usual lengths of the backup interval, and checks that both give the same
+ * entries. The histories of backup::FbKinematicsRing store only the poses, which are enough for the backup.
+ *
+ * Usage:
+ *   Benchmark_BackupReset [resets (default: 200)]
+ **/
+
+#include <mc_rtc/logging.h>
+
+#include <mc_state_observation/backup/FbKinematicsHistory.h>
+#include <mc_state_observation/profiling/LatencyHistogram.h>
+
+#include <boost/circular_buffer.hpp>
+#include <random>
+#include <string>
+
+namespace so = stateObservation;
+
+namespace mc_state_observation
+{
+
+/// @brief Returns a random pose of the floating base with velocities, as the ones estimated by the observers.
+so::kine::Kinematics randomFbKinematics(std::mt19937 & generator)
+{
+  std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+  auto randomVector = [&]()
+  { return so::Vector3(distribution(generator), distribution(generator), distribution(generator)); };
+
+  so::kine::Kinematics kine;
+  kine.position = randomVector();
+  kine.orientation = so::Matrix3(Eigen::AngleAxisd(distribution(generator) * M_PI, randomVector().normalized()));
+  kine.linVel = randomVector();
+  kine.angVel = randomVector();
+  return kine;
+}
+
+/// @brief Re-anchors each entry of the history, as done before the introduction of backup::FbKinematicsHistory.
+so::kine::Kinematics eagerBackup(boost::circular_buffer<so::kine::Kinematics> & koHistory,
+                                 const boost::circular_buffer<so::kine::Kinematics> & tiltHistory)
+{
+  so::kine::Kinematics worldResetKine = koHistory.front();
+  so::kine::Kinematics fbWorldInitBackup = tiltHistory.front().getInverse();
+  for(size_t i = 0; i < koHistory.size(); i++)
+  {
+    koHistory.at(i) = worldResetKine * (fbWorldInitBackup * tiltHistory.at(i));
+  }
+  return koHistory.back();
+}
+
+/// @brief Re-anchors the history in constant time.
+so::kine::Kinematics lazyBackup(backup::FbKinematicsHistory & koHistory, const backup::FbKinematicsRing & tiltHistory)
+{
+  so::kine::Kinematics worldResetKine = koHistory.front();
+  so::kine::Kinematics fbWorldInitBackup = tiltHistory.front().getInverse();
+  koHistory.reanchor(worldResetKine * fbWorldInitBackup, tiltHistory);
+  so::kine::Kinematics worldFbKine = koHistory.back();
+  koHistory.setBack(worldFbKine);
+  return worldFbKine;
+}
+
+/// @brief Measures the computation time of both backups for the given length of the history and returns the largest
+/// difference between the entries they give.
+double benchmark(size_t capacity,
+                 size_t nbResets,
+                 profiling::LatencyHistogram & eagerLatencies,
+                 profiling::LatencyHistogram & lazyLatencies)
+{
+  std::mt19937 generator(42);
+
+  boost::circular_buffer<so::kine::Kinematics> eagerTiltHistory(capacity);
+  boost::circular_buffer<so::kine::Kinematics> eagerHistory(capacity);
+  backup::FbKinematicsRing lazyTiltHistory;
+  lazyTiltHistory.set_capacity(capacity);
+  backup::FbKinematicsHistory lazyHistory;
+  lazyHistory.set_capacity(capacity);
+
+  double maxError = 0.0;
+  for(size_t k = 0; k < nbResets; ++k)
+  {
+    // the histories are filled over a whole backup interval between two resets
+    for(size_t i = 0; i < capacity; ++i)
+    {
+      const so::kine::Kinematics koKine = randomFbKinematics(generator);
+      const so::kine::Kinematics tiltKine = randomFbKinematics(generator);
+      eagerTiltHistory.push_back(tiltKine);
+      lazyTiltHistory.push_back(tiltKine);
+      eagerHistory.push_back(koKine);
+      lazyHistory.push_back(koKine);
+    }
+
+    {
+      profiling::ScopedTimer timer(&eagerLatencies);
+      eagerBackup(eagerHistory, eagerTiltHistory);
+    }
+    {
+      profiling::ScopedTimer timer(&lazyLatencies);
+      lazyBackup(lazyHistory, lazyTiltHistory);
+    }
+
+    // the re-anchored entries are computed only when they are read, which is not part of the reset iteration
+    for(size_t i = 0; i < capacity; ++i)
+    {
+      const so::kine::Kinematics lazyKine = lazyHistory.at(i);
+      maxError = std::max(maxError, (lazyKine.position() - eagerHistory.at(i).position()).norm());
+      maxError = std::max(maxError,
+                          (lazyKine.orientation.toMatrix3() - eagerHistory.at(i).orientation.toMatrix3()).norm());
+    }
+  }
+  return maxError;
+}
+
+} // namespace mc_state_observation
+
+int main(int argc, char * argv[])
+{
+  using namespace mc_state_observation;
+
+  size_t nbResets = 200;
+  if(argc > 1) { nbResets = std::stoul(argv[1]); }
+
+  mc_rtc::log::info("Memory per entry of the history: {} bytes in a buffer of Kinematics, {} bytes in FbKinematicsRing",
+                    sizeof(so::kine::Kinematics), 7 * sizeof(double));
+  mc_rtc::log::info("Computation time of the backup on the reset iteration over {} resets [us]", nbResets);
+  mc_rtc::log::info("entries |  eager p99 |  eager max |   lazy p99 |   lazy max | max difference");
+  // backup intervals of 1 s, 5 s and 10 s at 1 kHz
+  for(size_t capacity : {1000u, 5000u, 10000u})
+  {
+    profiling::LatencyHistogram eagerLatencies;
+    profiling::LatencyHistogram lazyLatencies;
+    const double maxError = benchmark(capacity, nbResets, eagerLatencies, lazyLatencies);
+    mc_rtc::log::info("{:>7} | {:>10.1f} | {:>10.1f} | {:>10.1f} | {:>10.1f} | {:>14.2e}", capacity,
+                      eagerLatencies.percentile(0.99), eagerLatencies.max(), lazyLatencies.percentile(0.99),
+                      lazyLatencies.max(), maxError);
+  }
+
+  return 0;
+}
@@ -0,0 +1,172 @@
+/**
+ * Benchmark of the computation time of the Kinetics Observer's update depending on the amount of contacts and IMUs.
+ *
+ * A robot standing still on a varying amount of contacts (2: feet, 4: feet and hands, 6: feet, hands and knees) and
+ * with a varying amount of IMUs is simulated, and the computation time of the update of the Kinetics Observer is
+ * measured for each combination. The state vector and covariance matrix of the Kinetics Observer are sized with the
+ * maximum amounts of contacts and IMUs, the same way as in MCKineticsObserver.
+ *
+ * Usage:
+ *   Benchmark_KoScaling [iterations (default: 2000)]
+ **/
+
+#include <mc_rtc/logging.h>
+
+#include <mc_state_observation/profiling/LatencyHistogram.h>
+
+#include <state-observation/dynamics-estimators/kinetics-observer.hpp>
+
+#include <string>
+
+namespace so = stateObservation;
+
+namespace mc_state_observation
+{
+
+/// @brief Initial covariance of the contacts' state
+so::Matrix12 contactInitCovariance()
+{
+  so::Matrix12 contactInitCov = so::Matrix12::Identity() * 1e-8;
+  contactInitCov.block<3, 3>(6, 6) = so::Matrix3::Identity() * 400;
+  contactInitCov.block<3, 3>(9, 9) = so::Matrix3::Identity() * 360;
+  return contactInitCov;
+}
+
+/// @brief Process covariance of the contacts' state
+so::Matrix12 contactProcessCovariance()
+{
+  so::Matrix12 contactProcessCov = so::Matrix12::Zero();
+  contactProcessCov.block<3, 3>(6, 6) = so::Matrix3::Identity() * 250;
+  contactProcessCov.block<3, 3>(9, 9) = so::Matrix3::Identity() * 250;
+  return contactProcessCov;
+}
+
+/// @brief Sets covariances close to the ones used on our robots (see etc/observers/MCKineticsObserver.yaml)
+void setCovariances(so::KineticsObserver & observer)
+{
+  observer.setKinematicsInitCovarianceDefault(so::Matrix3::Identity() * 1e-6, so::Matrix3::Identity() * 1e-6,
+                                              so::Matrix3::Identity() * 1e-6, so::Matrix3::Identity() * 1e-6);
+  observer.setGyroBiasInitCovarianceDefault(so::Matrix3::Identity() * 1e-8);
+  observer.setUnmodeledWrenchInitCovMatDefault(so::Matrix6::Identity() * 1e-2);
+  observer.setContactInitCovMatDefault(contactInitCovariance());
+  observer.resetStateCovarianceMat();
+
+  observer.setKinematicsProcessCovarianceDefault(so::Matrix3::Identity() * 1e-10, so::Matrix3::Identity() * 1e-12,
+                                                 so::Matrix3::Identity() * 1e-10, so::Matrix3::Identity() * 1e-10);
+  observer.setGyroBiasProcessCovarianceDefault(so::Matrix3::Identity() * 1e-12);
+  observer.setUnmodeledWrenchProcessCovarianceDefault(so::Matrix6::Identity() * 9e-2);
+  observer.setContactProcessCovarianceDefault(contactProcessCovariance());
+  observer.resetProcessCovarianceMat();
+
+  observer.setIMUDefaultCovarianceMatrix(so::Matrix3::Identity() * 1e-4, so::Matrix3::Identity() * 1e-6);
+  so::Matrix6 contactSensorCov = so::Matrix6::Identity() * 20;
+  contactSensorCov.block<3, 3>(3, 3) = so::Matrix3::Identity() * 1.5;
+  observer.setContactWrenchSensorDefaultCovarianceMatrix(contactSensorCov);
+}
+
+/// @brief Measures the computation time of the update of the Kinetics Observer for the given amount of contacts and
+/// IMUs.
+profiling::LatencyHistogram::Stats benchmark(unsigned nbContacts, unsigned nbIMUs, size_t nbIter)
+{
+  const double dt = 0.001;
+  const double mass = 40.0;
+  const so::Vector3 com(0.0, 0.0, 0.8);
+
+  so::KineticsObserver observer(nbContacts, nbIMUs);
+  observer.setSamplingTime(dt);
+  observer.setMass(mass);
+  observer.setWithUnmodeledWrench(true);
+  observer.setWithGyroBias(true);
+  observer.setWithAccelerationEstimation(true);
+  setCovariances(observer);
+
+  so::Vector initStateVector = so::Vector::Zero(observer.getStateSize());
+  initStateVector.segment(observer.posIndex(), observer.sizePos) = com;
+  initStateVector.segment(observer.oriIndex(), observer.sizeOri) =
+      so::kine::Orientation(so::Matrix3(so::Matrix3::Identity())).toVector4();
+  observer.setInitWorldCentroidStateVector(initStateVector);
+
+  // feet, hands and knees positions in the floating base's frame
+  const std::vector<so::Vector3> contactsPositions = {{0.0, -0.1, -0.8}, {0.0, 0.1, -0.8}, {0.4, -0.3, -0.3},
+                                                      {0.4, 0.3, -0.3},  {0.3, -0.1, -0.6}, {0.3, 0.1, -0.6}};
+
+  const so::Matrix3 stiffness = so::Matrix3::Identity() * 4e4;
+  const so::Matrix3 damping = so::Matrix3::Identity() * 500;
+  const so::Matrix3 acceleroCov = so::Matrix3::Identity() * 1e-4;
+  const so::Matrix3 gyroCov = so::Matrix3::Identity() * 1e-6;
+  so::Matrix6 contactSensorCov = so::Matrix6::Identity() * 20;
+  contactSensorCov.block<3, 3>(3, 3) = so::Matrix3::Identity() * 1.5;
+
+  std::vector<so::kine::Kinematics> fbContactsKine(nbContacts);
+  for(unsigned i = 0; i < nbContacts; ++i)
+  {
+    fbContactsKine[i] = so::kine::Kinematics::zeroKinematics(so::kine::Kinematics::Flags::all);
+    fbContactsKine[i].position = contactsPositions[i];
+    so::kine::Kinematics worldContactKineRef = fbContactsKine[i];
+    observer.addContact(worldContactKineRef, contactInitCovariance(), contactProcessCovariance(), static_cast<int>(i),
+                        stiffness, damping, stiffness, damping);
+  }
+
+  // each contact carries the same share of the weight of the robot
+  so::Vector6 contactWrench = so::Vector6::Zero();
+  contactWrench(2) = mass * so::cst::gravityConstant / nbContacts;
+
+  std::vector<so::kine::Kinematics> fbImusKine(nbIMUs);
+  for(unsigned i = 0; i < nbIMUs; ++i)
+  {
+    fbImusKine[i] = so::kine::Kinematics::zeroKinematics(so::kine::Kinematics::Flags::all);
+    fbImusKine[i].position = so::Vector3(0.0, 0.05 * i, 0.1);
+  }
+  const so::Vector3 accelero = so::cst::gravity.cwiseAbs();
+  const so::Vector3 gyro = so::Vector3::Zero();
+
+  profiling::LatencyHistogram latencies;
+  const size_t warmup = nbIter / 10;
+  for(size_t k = 0; k < nbIter + warmup; ++k)
+  {
+    profiling::ScopedTimer timer(k < warmup ? nullptr : &latencies);
+
+    observer.setCenterOfMass(com, so::Vector3::Zero(), so::Vector3::Zero());
+    observer.setCoMAngularMomentum(so::Vector3::Zero());
+    observer.setCoMInertiaMatrix(so::Matrix3::Identity() * mass * 0.1);
+    observer.setAdditionalWrench(so::Vector3::Zero(), so::Vector3::Zero());
+
+    for(unsigned i = 0; i < nbIMUs; ++i)
+    {
+      observer.setIMU(accelero, gyro, acceleroCov, gyroCov, fbImusKine[i], static_cast<int>(i));
+    }
+    for(unsigned i = 0; i < nbContacts; ++i)
+    {
+      observer.updateContactWithWrenchSensor(contactWrench, contactSensorCov, fbContactsKine[i], i);
+    }
+
+    observer.update();
+  }
+
+  return latencies.stats();
+}
+
+} // namespace mc_state_observation
+
+int main(int argc, char * argv[])
+{
+  using namespace mc_state_observation;
+
+  size_t nbIter = 2000;
+  if(argc > 1) { nbIter = std::stoul(argv[1]); }
+
+  mc_rtc::log::info("Computation time of the Kinetics Observer's update over {} iterations [us]", nbIter);
+  mc_rtc::log::info("contacts | IMUs | state size |     min |    mean |     p99 |     max");
+  for(unsigned nbContacts : {2u, 4u, 6u})
+  {
+    for(unsigned nbIMUs : {1u, 2u, 3u})
+    {
+      const auto stats = benchmark(nbContacts, nbIMUs, nbIter);
+      mc_rtc::log::info("{:>8} | {:>4} | {:>10} | {:>7.1f} | {:>7.1f} | {:>7.1f} | {:>7.1f}", nbContacts, nbIMUs,
+                        so::KineticsObserver(nbContacts, nbIMUs).getStateSize(), stats.min, stats.mean, stats.p99,
+                        stats.max);
+    }
+  }
+
+  return 0;
+}
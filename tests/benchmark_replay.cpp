@@ -0,0 +1,248 @@
+/**
+ * Offline benchmark of the observers of mc_state_observation.
+ *
+ * The measurements recorded in a mc_rtc binary log are fed directly to the configure / reset / run / update functions
+ * of an observer, without running a controller nor a simulation. The computation time of each iteration is measured
+ * and the throughput and the latency percentiles are reported at the end of the replay.
+ *
+ * Usage:
+ *   Benchmark_Replay <observer type> <observer configuration (yaml)> <log (bin)> [options]
+ * Options:
+ *   --robot <module>        robot module used to record the log (default: JVRC1)
+ *   --dt <timestep>         timestep of the log (default: deduced from the "t" entry of the log)
+ *   --module-path <path>    additional path in which the observers libraries are searched
+ *   --iterations <n>        maximum number of replayed iterations (default: the whole log)
+ *   --warmup <n>            number of iterations excluded from the statistics (default: 100)
+ **/
+
+#include <mc_control/MCController.h>
+#include <mc_observers/ObserverLoader.h>
+#include <mc_rbdyn/RobotLoader.h>
+#include <mc_rtc/log/FlatLog.h>
+#include <mc_rtc/logging.h>
+
+#include <mc_state_observation/profiling/LatencyHistogram.h>
+
+#include <chrono>
+#include <iostream>
+#include <limits>
+
+namespace mc_state_observation
+{
+
+/// @brief Minimal controller used only as a container for the robots, the datastore and the logger required by the
+/// observers.
+struct ReplayController : public mc_control::MCController
+{
+  ReplayController(mc_rbdyn::RobotModulePtr rm, double dt) : mc_control::MCController(rm, dt)
+  {
+    // some observers retrieve the name of the pipeline they belong to
+    observerPipelines_.emplace_back(*this, "ReplayPipeline");
+  }
+};
+
+/// @brief Measurements read from the log at a given iteration
+struct ReplayedEntries
+{
+  std::vector<const std::vector<double> *> qIn;
+  std::vector<const std::vector<double> *> alphaIn;
+  std::vector<const std::vector<double> *> qOut;
+  std::vector<const sva::PTransformd *> ff;
+
+  struct BodySensorEntries
+  {
+    std::string name;
+    std::vector<const Eigen::Quaterniond *> orientation;
+    std::vector<const Eigen::Vector3d *> angularVelocity;
+    std::vector<const Eigen::Vector3d *> linearAcceleration;
+  };
+  std::vector<BodySensorEntries> bodySensors;
+
+  std::vector<std::pair<std::string, std::vector<const sva::ForceVecd *>>> forceSensors;
+};
+
+/// @brief Copies the joint values given in the reference joint order into the configuration of the robot.
+void setJointValues(mc_rbdyn::Robot & robot,
+                    const std::vector<double> & values,
+                    std::vector<std::vector<double>> & mbcValues)
+{
+  const auto & refJointOrder = robot.refJointOrder();
+  for(size_t i = 0; i < refJointOrder.size() && i < values.size(); ++i)
+  {
+    const auto & jointName = refJointOrder[i];
+    if(!robot.hasJoint(jointName)) { continue; }
+    auto jIndex = robot.jointIndexByName(jointName);
+    if(mbcValues[jIndex].size() == 1) { mbcValues[jIndex][0] = values[i]; }
+  }
+}
+
+/// @brief Updates the control and real robots of the controller with the log data of the given iteration.
+void applyLogIteration(ReplayController & ctl, const ReplayedEntries & entries, size_t i)
+{
+  auto & robot = ctl.robots().robot();
+  auto & realRobot = ctl.realRobots().robot();
+
+  if(entries.ff[i]) { robot.posW(*entries.ff[i]); }
+  if(entries.qOut[i]) { setJointValues(robot, *entries.qOut[i], robot.mbc().q); }
+  robot.forwardKinematics();
+  robot.forwardVelocity();
+
+  // the floating base of the real robot is given by the observers, we only update the encoders here
+  if(entries.qIn[i]) { setJointValues(realRobot, *entries.qIn[i], realRobot.mbc().q); }
+  if(entries.alphaIn[i]) { setJointValues(realRobot, *entries.alphaIn[i], realRobot.mbc().alpha); }
+  realRobot.forwardKinematics();
+  realRobot.forwardVelocity();
+
+  for(const auto & bs : entries.bodySensors)
+  {
+    for(auto * r : {&robot, &realRobot})
+    {
+      auto & sensor = const_cast<mc_rbdyn::BodySensor &>(r->bodySensor(bs.name));
+      if(bs.orientation[i]) { sensor.orientation(*bs.orientation[i]); }
+      if(bs.angularVelocity[i]) { sensor.angularVelocity(*bs.angularVelocity[i]); }
+      if(bs.linearAcceleration[i]) { sensor.linearAcceleration(*bs.linearAcceleration[i]); }
+    }
+  }
+
+  for(const auto & [fsName, wrenches] : entries.forceSensors)
+  {
+    if(!wrenches[i]) { continue; }
+    for(auto * r : {&robot, &realRobot})
+    {
+      const_cast<mc_rbdyn::ForceSensor &>(r->forceSensor(fsName)).wrench(*wrenches[i]);
+    }
+  }
+}
+
+} // namespace mc_state_observation
+
+int main(int argc, char * argv[])
+{
+  using namespace mc_state_observation;
+
+  if(argc < 4)
+  {
+    std::cerr << "Usage: " << argv[0]
+              << " <observer type> <observer configuration (yaml)> <log (bin)> [--robot <module>] [--dt <timestep>] "
+                 "[--module-path <path>] [--iterations <n>] [--warmup <n>]"
+              << std::endl;
+    return 1;
+  }
+
+  const std::string observerType = argv[1];
+  const std::string observerConfigPath = argv[2];
+  const std::string logPath = argv[3];
+
+  std::string robotModule = "JVRC1";
+  double dt = 0.0;
+  size_t maxIterations = std::numeric_limits<size_t>::max();
+  size_t warmup = 100;
+  for(int i = 4; i + 1 < argc; i += 2)
+  {
+    const std::string opt = argv[i];
+    if(opt == "--robot") { robotModule = argv[i + 1]; }
+    else if(opt == "--dt") { dt = std::stod(argv[i + 1]); }
+    else if(opt == "--module-path") { mc_observers::ObserverLoader::append_path({argv[i + 1]}); }
+    else if(opt == "--iterations") { maxIterations = std::stoul(argv[i + 1]); }
+    else if(opt == "--warmup") { warmup = std::stoul(argv[i + 1]); }
+    else
+    {
+      mc_rtc::log::critical("Unknown option {}", opt);
+      return 1;
+    }
+  }
+
+  mc_rtc::log::info("Loading the log {}", logPath);
+  mc_rtc::log::FlatLog log(logPath);
+  if(log.size() < 2)
+  {
+    mc_rtc::log::critical("The log {} does not contain enough iterations", logPath);
+    return 1;
+  }
+
+  if(dt == 0.0)
+  {
+    const auto t = log.getRaw<double>("t");
+    if(!t[0] || !t[1])
+    {
+      mc_rtc::log::critical("The timestep cannot be deduced from the log, please provide it with --dt");
+      return 1;
+    }
+    dt = *t[1] - *t[0];
+  }
+
+  auto rm = mc_rbdyn::RobotLoader::get_robot_module(robotModule);
+  ReplayController ctl(rm, dt);
+
+  ReplayedEntries entries;
+  entries.qIn = log.getRaw<std::vector<double>>("qIn");
+  entries.alphaIn = log.getRaw<std::vector<double>>("alphaIn");
+  entries.qOut = log.getRaw<std::vector<double>>("qOut");
+  entries.ff = log.getRaw<sva::PTransformd>("ff");
+  for(const auto & bs : ctl.robot().bodySensors())
+  {
+    entries.bodySensors.push_back({bs.name(), log.getRaw<Eigen::Quaterniond>(bs.name() + "_orientation"),
+                                   log.getRaw<Eigen::Vector3d>(bs.name() + "_angularVelocity"),
+                                   log.getRaw<Eigen::Vector3d>(bs.name() + "_linearAcceleration")});
+  }
+  for(const auto & fs : ctl.robot().forceSensors())
+  {
+    if(log.has(fs.name())) { entries.forceSensors.push_back({fs.name(), log.getRaw<sva::ForceVecd>(fs.name())}); }
+  }
+
+  auto observer = mc_observers::ObserverLoader::get_observer(observerType, dt);
+  observer->name(observerType);
+
+  auto & logger = ctl.logger();
+  logger.start("Benchmark_Replay_" + observerType, dt);
+
+  applyLogIteration(ctl, entries, 0);
+  observer->configure(ctl, mc_rtc::Configuration(observerConfigPath));
+  observer->reset(ctl);
+  observer->addToLogger(ctl, logger, observerType);
+
+  const size_t nbIterations = std::min(log.size(), maxIterations);
+  profiling::LatencyHistogram latencies;
+  double runTime = 0.0; // total time spent in the observer [s]
+  size_t nbReplayed = 0; // number of iterations run, including the warmup
+  for(size_t i = 1; i < nbIterations; ++i)
+  {
+    applyLogIteration(ctl, entries, i);
+
+    auto start = std::chrono::steady_clock::now();
+    bool success = observer->run(ctl);
+    observer->update(ctl);
+    auto end = std::chrono::steady_clock::now();
+
+    if(!success)
+    {
+      mc_rtc::log::critical("The observer {} failed at iteration {}", observerType, i);
+      return 1;
+    }
+
+    // the logger provides the time to the observers
+    logger.log();
+
+    ++nbReplayed;
+    if(nbReplayed <= warmup) { continue; }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    latencies.record(static_cast<uint64_t>(elapsed));
+    runTime += static_cast<double>(elapsed) * 1e-9;
+  }
+
+  if(latencies.count() == 0)
+  {
+    mc_rtc::log::critical("No iteration was measured, the log is shorter than the warmup ({} iterations)", warmup);
+    return 1;
+  }
+
+  mc_rtc::log::success("Replayed {} iterations of {} with {} (warmup: {})", nbReplayed, logPath, observerType,
+                       warmup);
+  mc_rtc::log::info("Throughput: {:.1f} iterations/s", static_cast<double>(latencies.count()) / runTime);
+  mc_rtc::log::info("Latency [us]: min {:.2f} | mean {:.2f} | p50 {:.2f} | p90 {:.2f} | p99 {:.2f} | p99.9 {:.2f} | "
+                    "max {:.2f}",
+                    latencies.min(), latencies.mean(), latencies.percentile(0.5), latencies.percentile(0.9),
+                    latencies.percentile(0.99), latencies.percentile(0.999), latencies.max());
+
+  return 0;
+}
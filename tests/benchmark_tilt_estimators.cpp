@@ -0,0 +1,195 @@
+/**
+ * Benchmark of the computation time and accuracy of the tilt estimators used by the TiltObserver, MCVanyte and MCWaiko
+ * observers.
+ *
+ * The three estimators are given identical measurements of an IMU placed above a fixed contact, around which the robot
+ * sways. The gains are the default ones of the observers. The per-iteration computation time of each estimator is
+ * measured, along with its tilt error with respect to the simulated motion.
+ *
+ * Usage:
+ *   Benchmark_TiltEstimators [iterations (default: 20000)]
+ **/
+
+#include <mc_rtc/logging.h>
+
+#include <mc_state_observation/profiling/LatencyHistogram.h>
+
+#include <state-observation/observer/tilt-estimator-humanoid.hpp>
+#include <state-observation/observer/vanyt-estimator.hpp>
+#include <state-observation/observer/waiko.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+namespace so = stateObservation;
+
+namespace mc_state_observation
+{
+
+/// @brief Measurements of the IMU and of the contact on one iteration of the simulated motion.
+struct SimulatedSample
+{
+  // orientation of the IMU in the world
+  so::Matrix3 worldImuOri;
+  // position of the IMU in the world
+  so::Vector3 worldImuPos;
+  // local linear velocity of the IMU, as "measured" by the legged odometry
+  so::Vector3 yv;
+  so::Vector3 accelero;
+  so::Vector3 gyro;
+  // position of the contact in the frame of the IMU
+  so::Vector3 imuContactPos;
+};
+
+/// @brief Simulates the IMU swaying around a fixed contact placed at the origin of the world.
+class SwayingImu
+{
+public:
+  SwayingImu(double dt) : dt_(dt) {}
+
+  SimulatedSample sample(size_t k) const
+  {
+    const double t = static_cast<double>(k) * dt_;
+    SimulatedSample s;
+    s.worldImuOri = orientation(t);
+    s.gyro = s.worldImuOri.transpose() * angularVelocity(t);
+    s.worldImuPos = s.worldImuOri * contactImuPos_;
+
+    // the contact is fixed: the velocity and acceleration of the IMU only come from the rotation around it
+    const so::Vector3 worldAngVel = angularVelocity(t);
+    const so::Vector3 worldAngAcc = (angularVelocity(t + dt_) - angularVelocity(t - dt_)) / (2 * dt_);
+    const so::Vector3 worldImuLinVel = worldAngVel.cross(s.worldImuPos);
+    const so::Vector3 worldImuLinAcc =
+        worldAngAcc.cross(s.worldImuPos) + worldAngVel.cross(worldAngVel.cross(s.worldImuPos));
+
+    s.yv = s.worldImuOri.transpose() * worldImuLinVel;
+    s.accelero = s.worldImuOri.transpose() * (worldImuLinAcc + so::cst::gravityConstant * so::Vector3::UnitZ());
+    s.imuContactPos = -contactImuPos_;
+    return s;
+  }
+
+private:
+  so::Matrix3 orientation(double t) const
+  {
+    return so::Matrix3(Eigen::AngleAxisd(0.1 * std::sin(2.0 * t), so::Vector3::UnitX())
+                       * Eigen::AngleAxisd(0.05 * std::sin(3.0 * t), so::Vector3::UnitY()));
+  }
+
+  so::Vector3 angularVelocity(double t) const
+  {
+    // we differentiate the orientation numerically, which is accurate enough for the comparison
+    const double h = 1e-6;
+    const so::Matrix3 dR = orientation(t + h) * orientation(t - h).transpose();
+    return so::kine::rotationMatrixToRotationVector(dR) / (2 * h);
+  }
+
+private:
+  double dt_;
+  // position of the IMU in the frame of the contact
+  so::Vector3 contactImuPos_ = so::Vector3(0.0, 0.0, 1.0);
+};
+
+/// @brief Tilt error between the estimated and the actual orientations of the IMU.
+double tiltError(const so::Vector3 & estimatedTilt, const so::Matrix3 & worldImuOri)
+{
+  return (estimatedTilt - worldImuOri.transpose() * so::Vector3::UnitZ()).norm();
+}
+
+struct BenchmarkResult
+{
+  profiling::LatencyHistogram::Stats latencies;
+  double maxTiltError = 0.0;
+};
+
+/// @brief Runs the tilt estimator of the TiltObserver.
+BenchmarkResult benchmarkTiltEstimatorHumanoid(const SwayingImu & motion, double dt, size_t nbIter)
+{
+  so::TiltEstimatorHumanoid estimator(5, 1, 2, dt);
+  const SimulatedSample init = motion.sample(0);
+  const so::Vector3 initX2 = init.worldImuOri.transpose() * so::Vector3::UnitZ();
+  estimator.initEstimator(so::Vector3::Zero(), initX2, initX2);
+
+  BenchmarkResult result;
+  profiling::LatencyHistogram latencies;
+  const size_t warmup = nbIter / 10;
+  for(size_t k = 1; k <= nbIter + warmup; ++k)
+  {
+    const SimulatedSample s = motion.sample(k);
+    so::Vector xk;
+    {
+      profiling::ScopedTimer timer(k <= warmup ? nullptr : &latencies);
+      const auto time = estimator.getCurrentTime();
+      estimator.setMeasurement(s.yv, s.accelero, s.gyro, time + 1);
+      xk = estimator.getEstimatedState(time + 1);
+    }
+    if(k > warmup) { result.maxTiltError = std::max(result.maxTiltError, tiltError(xk.tail(3), s.worldImuOri)); }
+  }
+  result.latencies = latencies.stats();
+  return result;
+}
+
+/// @brief Runs the tilt estimator of MCVanyte or MCWaiko, with the same contact measurements as these observers.
+template<typename EstimatorT>
+BenchmarkResult benchmarkTiltEstimatorWithContacts(const SwayingImu & motion, double dt, size_t nbIter)
+{
+  EstimatorT estimator(5, 1, 1 / (2 * M_PI), dt);
+  const SimulatedSample init = motion.sample(0);
+  const so::Vector3 initX2 = init.worldImuOri.transpose() * so::Vector3::UnitZ();
+  estimator.initEstimator(init.worldImuPos, so::Vector3::Zero(), initX2,
+                          so::kine::Orientation(init.worldImuOri).toVector4());
+
+  BenchmarkResult result;
+  profiling::LatencyHistogram latencies;
+  const size_t warmup = nbIter / 10;
+  for(size_t k = 1; k <= nbIter + warmup; ++k)
+  {
+    const SimulatedSample s = motion.sample(k);
+    so::Vector xk;
+    {
+      profiling::ScopedTimer timer(k <= warmup ? nullptr : &latencies);
+      const auto time = estimator.getCurrentTime();
+      estimator.setRho(2);
+      estimator.setMeasurement(s.yv, s.accelero, s.gyro, time + 1);
+      estimator.addOrientationMeasurement(s.worldImuOri, 2);
+      estimator.addContactPosMeasurement(so::Vector3::Zero(), s.imuContactPos, 2, 1);
+      xk = estimator.getEstimatedState(time + 1);
+    }
+    if(k > warmup)
+    {
+      so::kine::Orientation estimatedOri;
+      estimatedOri.fromVector4(xk.tail(4));
+      const so::Vector3 estimatedTilt = estimatedOri.toMatrix3().transpose() * so::Vector3::UnitZ();
+      result.maxTiltError = std::max(result.maxTiltError, tiltError(estimatedTilt, s.worldImuOri));
+    }
+  }
+  result.latencies = latencies.stats();
+  return result;
+}
+
+} // namespace mc_state_observation
+
+int main(int argc, char * argv[])
+{
+  using namespace mc_state_observation;
+
+  size_t nbIter = 20000;
+  if(argc > 1) { nbIter = std::stoul(argv[1]); }
+
+  const double dt = 0.001;
+  const SwayingImu motion(dt);
+
+  auto print = [](const std::string & name, const BenchmarkResult & result)
+  {
+    mc_rtc::log::info("{:>21} | {:>7.2f} | {:>7.2f} | {:>7.2f} | {:>7.2f} | {:>14.2e}", name, result.latencies.min,
+                      result.latencies.mean, result.latencies.p99, result.latencies.max, result.maxTiltError);
+  };
+
+  mc_rtc::log::info("Computation time of one iteration of the tilt estimators over {} iterations [us]", nbIter);
+  mc_rtc::log::info("            estimator |     min |    mean |     p99 |     max | max tilt error");
+  print("TiltEstimatorHumanoid", benchmarkTiltEstimatorHumanoid(motion, dt, nbIter));
+  print("VanytEstimator", benchmarkTiltEstimatorWithContacts<so::VanytEstimator>(motion, dt, nbIter));
+  print("Waiko", benchmarkTiltEstimatorWithContacts<so::Waiko>(motion, dt, nbIter));
+
+  return 0;
+}
@@ -0,0 +1,179 @@
+/**
+ * Checks that the steady-state iterations of the Kinetics Observer don't perform any heap allocation.
+ *
+ * The allocation functions of the C library are replaced by counting versions. The default operator new and the
+ * aligned allocator of Eigen both rely on malloc, so their allocations are counted too. The observer is run on a robot
+ * standing still on its two feet and, after a warm-up during which the contacts get set and the buffers reach their
+ * final size, the test fails if any call to run() allocates. The allocations made by the estimators of the
+ * state-observation library are excluded from the count (see profiling/AllocationTracking.h), but not the copy of
+ * their results into the buffers of the observer.
+ **/
+
+#include <mc_control/MCController.h>
+#include <mc_observers/ObserverLoader.h>
+#include <mc_rbdyn/RobotLoader.h>
+#include <mc_rtc/logging.h>
+
+#include <mc_state_observation/profiling/AllocationTracking.h>
+
+#include <state-observation/tools/definitions.hpp>
+
+#include <atomic>
+#include <cerrno>
+
+extern "C"
+{
+  void * __libc_malloc(size_t size);
+  void * __libc_calloc(size_t nmemb, size_t size);
+  void * __libc_realloc(void * ptr, size_t size);
+  void * __libc_memalign(size_t alignment, size_t size);
+}
+
+namespace
+{
+
+// the hook doesn't call the library before main, which could happen before its initialization
+std::atomic<bool> hookEnabled{false};
+// number of allocations made while the tracking was started
+std::atomic<size_t> nbAllocations{0};
+
+inline void countAllocation() noexcept
+{
+  if(hookEnabled.load(std::memory_order_relaxed) && mc_state_observation::profiling::allocations::tracked())
+  {
+    nbAllocations.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+} // namespace
+
+extern "C"
+{
+  void * malloc(size_t size)
+  {
+    countAllocation();
+    return __libc_malloc(size);
+  }
+
+  void * calloc(size_t nmemb, size_t size)
+  {
+    countAllocation();
+    return __libc_calloc(nmemb, size);
+  }
+
+  void * realloc(void * ptr, size_t size)
+  {
+    countAllocation();
+    return __libc_realloc(ptr, size);
+  }
+
+  void * memalign(size_t alignment, size_t size)
+  {
+    countAllocation();
+    return __libc_memalign(alignment, size);
+  }
+
+  void * aligned_alloc(size_t alignment, size_t size)
+  {
+    countAllocation();
+    return __libc_memalign(alignment, size);
+  }
+
+  int posix_memalign(void ** memptr, size_t alignment, size_t size)
+  {
+    countAllocation();
+    void * ptr = __libc_memalign(alignment, size);
+    if(ptr == nullptr) { return ENOMEM; }
+    *memptr = ptr;
+    return 0;
+  }
+}
+
+namespace mc_state_observation
+{
+
+/// @brief Minimal controller used only as a container for the robots, the datastore and the logger required by the
+/// observer.
+struct AllocationsController : public mc_control::MCController
+{
+  AllocationsController(mc_rbdyn::RobotModulePtr rm, double dt) : mc_control::MCController(rm, dt)
+  {
+    // some observers retrieve the name of the pipeline they belong to
+    observerPipelines_.emplace_back(*this, "AllocationsPipeline");
+  }
+};
+
+/// @brief Gives to the control and real robots the measurements of a robot standing still on its two feet.
+void setStandingMeasurements(AllocationsController & ctl)
+{
+  const double halfWeight = ctl.robot().mass() * stateObservation::cst::gravityConstant / 2;
+  for(auto * robot : {&ctl.robots().robot(), &ctl.realRobots().robot()})
+  {
+    robot->forwardKinematics();
+    robot->forwardVelocity();
+    robot->forwardAcceleration();
+
+    auto & imu = const_cast<mc_rbdyn::BodySensor &>(robot->bodySensor());
+    imu.linearAcceleration(Eigen::Vector3d(0.0, 0.0, stateObservation::cst::gravityConstant));
+    imu.angularVelocity(Eigen::Vector3d::Zero());
+
+    for(const auto & fsName : {"RightFootForceSensor", "LeftFootForceSensor"})
+    {
+      const_cast<mc_rbdyn::ForceSensor &>(robot->forceSensor(fsName))
+          .wrench(sva::ForceVecd(Eigen::Vector3d::Zero(), Eigen::Vector3d(0.0, 0.0, halfWeight)));
+    }
+  }
+}
+
+} // namespace mc_state_observation
+
+int main()
+{
+  using namespace mc_state_observation;
+
+  hookEnabled = true;
+
+  const double dt = 0.005;
+  const size_t warmup = 500;
+  const size_t nbIter = 1000;
+
+  auto rm = mc_rbdyn::RobotLoader::get_robot_module("JVRC1");
+  AllocationsController ctl(rm, dt);
+  setStandingMeasurements(ctl);
+
+  mc_observers::ObserverLoader::clear();
+  mc_observers::ObserverLoader::append_path({TEST_ALLOCATIONS_MODULE_PATH});
+  auto observer = mc_observers::ObserverLoader::get_observer("MCKineticsObserver", dt);
+  observer->name("MCKineticsObserver");
+  observer->configure(ctl, mc_rtc::Configuration(TEST_ALLOCATIONS_CONFIG));
+  observer->reset(ctl);
+  observer->addToLogger(ctl, ctl.logger(), "MCKineticsObserver");
+
+  for(size_t i = 0; i < warmup + nbIter; ++i)
+  {
+    const bool measured = i >= warmup;
+    const size_t nbAllocationsBefore = nbAllocations.load();
+
+    if(measured) { profiling::allocations::startTracking(); }
+    const bool success = observer->run(ctl);
+    profiling::allocations::stopTracking();
+
+    if(!success)
+    {
+      mc_rtc::log::critical("The observer failed at iteration {}", i);
+      return 1;
+    }
+    if(nbAllocations.load() != nbAllocationsBefore)
+    {
+      mc_rtc::log::critical("{} allocations were made by the observer at iteration {} (after a warm-up of {} "
+                            "iterations)",
+                            nbAllocations.load() - nbAllocationsBefore, i, warmup);
+      return 1;
+    }
+
+    observer->update(ctl);
+  }
+
+  mc_rtc::log::success("No allocation was made by the observer over {} iterations", nbIter);
+  return 0;
+}
@@ -0,0 +1,107 @@
+/**
+ * Checks the analytical Jacobians of the AttitudeObserver against the ones computed by finite differences by its
+ * extended Kalman filter.
+ *
+ * The Jacobians are compared on random states whose orientation is close to the identity, random, or close to a half
+ * turn, where the rotation vectors given by the filter reach their maximum angle (pi). The observer is compiled in the
+ * test to access its filter.
+ **/
+
+#include <mc_state_observation/AttitudeObserver.h>
+
+#include <mc_rtc/logging.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace so = stateObservation;
+
+namespace mc_state_observation
+{
+
+/// @brief Gives access to the Jacobians and to the filter of the AttitudeObserver.
+struct AttitudeObserverJacobians : public AttitudeObserver
+{
+  using AttitudeObserver::AttitudeObserver;
+
+  /// @brief Computes the Jacobians at the given state and input, analytically and by finite differences.
+  /// @return The largest difference between the coefficients of the Jacobians computed with both methods.
+  double jacobiansError(const so::Vector & x, const so::Vector & u)
+  {
+    xk_ = x;
+    uk_ = u;
+    computeJacobians();
+
+    // the filter is given the state and the input as in the run of the observer with the finite differences
+    filter_.reset();
+    filter_.setState(xk_, 0);
+    filter_.setInput(uk_, 0);
+    filter_.setMeasurement(so::Vector::Zero(MEASUREMENT_SIZE), 1);
+    const so::Vector dx = filter_.stateVectorConstant(1) * 1e-8;
+    const so::Matrix aFD = filter_.getAMatrixFD(dx);
+    const so::Matrix cFD = filter_.getCMatrixFD(dx);
+
+    return std::max((a_ - aFD).cwiseAbs().maxCoeff(), (c_ - cFD).cwiseAbs().maxCoeff());
+  }
+
+  static constexpr unsigned stateSize = STATE_SIZE;
+  static constexpr unsigned inputSize = INPUT_SIZE;
+};
+
+} // namespace mc_state_observation
+
+int main()
+{
+  using namespace mc_state_observation;
+  using indexes = AttitudeObserver::indexes;
+
+  const double dt = 0.005;
+  const double tolerance = 1e-4;
+  const size_t nbRandomStates = 100;
+
+  AttitudeObserverJacobians observer("Attitude", dt);
+
+  std::mt19937 generator(42);
+  std::normal_distribution<double> normal;
+  auto randomVector = [&generator, &normal]()
+  { return so::Vector3(normal(generator), normal(generator), normal(generator)); };
+
+  // angles of the orientations of the checked states. The angular velocity of the states is small enough for the
+  // predicted orientation to stay on the same side of a half turn, where the rotation vector is discontinuous.
+  std::vector<double> angles = {0.0, 1e-6, 1e-3, M_PI - 1e-2, M_PI - 1e-3};
+  std::uniform_real_distribution<double> randomAngle(0.0, M_PI - 1e-2);
+  for(size_t i = 0; i < nbRandomStates; ++i) { angles.push_back(randomAngle(generator)); }
+
+  for(const double angle : angles)
+  {
+    // the states are also checked without angular velocity nor acceleration, which keeps the predicted orientation at
+    // the same angle
+    for(const bool still : {true, false})
+    {
+      so::Vector x = so::Vector::Zero(AttitudeObserverJacobians::stateSize);
+      x.segment<3>(indexes::pos) = randomVector();
+      x.segment<3>(indexes::linVel) = randomVector();
+      x.segment<3>(indexes::linAcc) = randomVector();
+      x.segment<3>(indexes::ori) = angle * randomVector().normalized();
+      if(!still)
+      {
+        x.segment<3>(indexes::angVel) = 0.1 * randomVector();
+        x.segment<3>(indexes::angAcc) = 0.1 * randomVector();
+      }
+      so::Vector u(AttitudeObserverJacobians::inputSize);
+      u << randomVector(), randomVector();
+
+      const double error = observer.jacobiansError(x, u);
+      if(!(error <= tolerance))
+      {
+        mc_rtc::log::critical("The analytical Jacobians differ from the finite differences by {} for the state {}",
+                              error, x.transpose());
+        return 1;
+      }
+    }
+  }
+
+  mc_rtc::log::success("The analytical Jacobians match the finite differences on {} states", 2 * angles.size());
+  return 0;
+}
@@ -0,0 +1,107 @@
+/**
+ * Checks the EventRing used to publish the contact transitions of the ContactsManager.
+ *
+ * The events are read in the order they were pushed, a reader starting at written() only reads the upcoming events,
+ * and a reader overtaken by the writer skips the overwritten events and is told how many it missed.
+ **/
+
+#include <mc_state_observation/concurrency/EventRing.h>
+
+#include <mc_rtc/logging.h>
+
+#include <cstdint>
+
+using namespace mc_state_observation::concurrency;
+
+namespace
+{
+
+constexpr size_t capacity = 8;
+using Ring = EventRing<uint64_t, capacity>;
+
+bool check(bool condition, const std::string & message)
+{
+  if(!condition) { mc_rtc::log::critical(message); }
+  return condition;
+}
+
+/// @brief The events are polled in the order they were pushed, and poll returns false once they are all read.
+bool checkPollOrder()
+{
+  Ring ring;
+  uint64_t cursor = 0;
+  uint64_t missed = 0;
+  uint64_t event = 0;
+  if(!check(!ring.poll(cursor, event, &missed), "An empty ring returned an event")) { return false; }
+
+  for(uint64_t i = 0; i < capacity; ++i) { ring.push(i); }
+  for(uint64_t i = 0; i < capacity; ++i)
+  {
+    if(!check(ring.poll(cursor, event, &missed), "An event of a full ring could not be polled")) { return false; }
+    if(!check(event == i, fmt::format("Polled the event {} instead of {}", event, i))) { return false; }
+  }
+  return check(!ring.poll(cursor, event, &missed), "A ring returned an event after all its events were read")
+         && check(cursor == capacity, fmt::format("The cursor is {} instead of {}", cursor, capacity))
+         && check(missed == 0, fmt::format("The reader missed {} events without lagging", missed));
+}
+
+/// @brief A reader initialized with written() reads only the events pushed afterwards.
+bool checkUpcomingEvents()
+{
+  Ring ring;
+  for(uint64_t i = 0; i < 3; ++i) { ring.push(i); }
+
+  uint64_t cursor = ring.written();
+  uint64_t event = 0;
+  if(!check(!ring.poll(cursor, event), "A reader starting at written() read a past event")) { return false; }
+  ring.push(42);
+  return check(ring.poll(cursor, event), "A reader starting at written() could not read the upcoming event")
+         && check(event == 42, fmt::format("Polled the event {} instead of 42", event))
+         && check(!ring.poll(cursor, event), "A reader read more events than were pushed");
+}
+
+/// @brief A lagging reader skips the overwritten events, resumes at the oldest event still available, and counts the
+/// events it missed.
+bool checkLaggingReader()
+{
+  Ring ring;
+  uint64_t cursor = 0;
+  uint64_t missed = 0;
+  uint64_t event = 0;
+
+  // the reader reads the first events, then lags behind the writer
+  for(uint64_t i = 0; i < 2; ++i) { ring.push(i); }
+  for(uint64_t i = 0; i < 2; ++i) { ring.poll(cursor, event, &missed); }
+  const uint64_t nbPushed = 3 * capacity + 5;
+  for(uint64_t i = 2; i < nbPushed; ++i) { ring.push(i); }
+
+  const uint64_t expectedMissed = nbPushed - capacity - cursor;
+  const uint64_t oldest = nbPushed - capacity;
+  for(uint64_t i = oldest; i < nbPushed; ++i)
+  {
+    if(!check(ring.poll(cursor, event, &missed), "An event of a lagging reader could not be polled")) { return false; }
+    if(!check(event == i, fmt::format("Polled the event {} instead of {}", event, i))) { return false; }
+  }
+  if(!check(!ring.poll(cursor, event, &missed), "A lagging reader read more events than were available"))
+  {
+    return false;
+  }
+  if(!check(missed == expectedMissed, fmt::format("Missed {} events instead of {}", missed, expectedMissed)))
+  {
+    return false;
+  }
+
+  // once caught up, the reader doesn't miss any event anymore
+  ring.push(nbPushed);
+  return check(ring.poll(cursor, event, &missed) && event == nbPushed, "A reader that caught up missed an event")
+         && check(missed == expectedMissed, "A reader that caught up counted missed events");
+}
+
+} // namespace
+
+int main()
+{
+  if(!checkPollOrder() || !checkUpcomingEvents() || !checkLaggingReader()) { return 1; }
+  mc_rtc::log::success("The EventRing delivers the events in order and counts the missed ones");
+  return 0;
+}
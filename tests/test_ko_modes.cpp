@@ -0,0 +1,405 @@
+/**
+ * Checks the behavior of the execution modes of the Kinetics Observer.
+ *
+ * The observer is run on a robot standing still on its two feet, with the configuration of Test_KoModes.yaml modified
+ * to enable the checked mode. Its estimation is compared with the one of the default synchronous mode, and the
+ * computation time histograms published in the datastore are used to count the updates of the Kinetics Observer.
+ *
+ * Usage:
+ *   Test_KoModes <mode>
+ * Modes:
+ *   async                   update of the Kinetics Observer on a worker thread
+ *   delayedPose             fusion of absolute pose measurements received with a delay
+ *   multiRate               update of the Kinetics Observer at a sub-rate, the Tilt Observer filling in
+ *   timeBudget              fallback to the Tilt Observer when the update exceeds its time budget
+ *   checkpoint              warm start from the state saved by the previous run
+ *   contactEvents           transitions of the contacts polled from the datastore while a foot is lifted
+ **/
+
+#include <mc_control/MCController.h>
+#include <mc_observers/ObserverLoader.h>
+#include <mc_rbdyn/RobotLoader.h>
+#include <mc_rtc/logging.h>
+
+#include <mc_state_observation/measurements/ContactsManager.h>
+#include <mc_state_observation/profiling/LatencyHistogram.h>
+
+#include <state-observation/tools/definitions.hpp>
+
+#include <cmath>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <tuple>
+#include <vector>
+
+namespace mc_state_observation
+{
+
+/// @brief Minimal controller used only as a container for the robots, the datastore and the logger required by the
+/// observer.
+struct KoModesController : public mc_control::MCController
+{
+  KoModesController(mc_rbdyn::RobotModulePtr rm, double dt) : mc_control::MCController(rm, dt)
+  {
+    // some observers retrieve the name of the pipeline they belong to
+    observerPipelines_.emplace_back(*this, "KoModesPipeline");
+  }
+};
+
+/// @brief Brings the real robot back to the pose of the control robot and gives to both robots the measurements of a
+/// robot standing still on its two feet.
+void setStandingMeasurements(KoModesController & ctl)
+{
+  ctl.realRobots().robot().posW(ctl.robots().robot().posW());
+
+  const double halfWeight = ctl.robot().mass() * stateObservation::cst::gravityConstant / 2;
+  for(auto * robot : {&ctl.robots().robot(), &ctl.realRobots().robot()})
+  {
+    robot->forwardKinematics();
+    robot->forwardVelocity();
+    robot->forwardAcceleration();
+
+    auto & imu = const_cast<mc_rbdyn::BodySensor &>(robot->bodySensor());
+    imu.linearAcceleration(Eigen::Vector3d(0.0, 0.0, stateObservation::cst::gravityConstant));
+    imu.angularVelocity(Eigen::Vector3d::Zero());
+
+    for(const auto & fsName : {"RightFootForceSensor", "LeftFootForceSensor"})
+    {
+      const_cast<mc_rbdyn::ForceSensor &>(robot->forceSensor(fsName))
+          .wrench(sva::ForceVecd(Eigen::Vector3d::Zero(), Eigen::Vector3d(0.0, 0.0, halfWeight)));
+    }
+  }
+}
+
+/// @brief Kinetics Observer loaded from its library and run on the robot standing still. The observer is destroyed
+/// with this object, which removes its entries from the datastore.
+struct KoUnderTest
+{
+  KoUnderTest(KoModesController & ctl, const std::string & name, const mc_rtc::Configuration & config) : ctl_(ctl)
+  {
+    setStandingMeasurements(ctl_);
+    observer_ = mc_observers::ObserverLoader::get_observer("MCKineticsObserver", ctl_.timeStep);
+    observer_->name(name);
+    observer_->configure(ctl_, config);
+    observer_->reset(ctl_);
+    observer_->addToLogger(ctl_, ctl_.logger(), name);
+  }
+
+  ~KoUnderTest() { observer_->removeFromLogger(ctl_.logger(), observer_->name()); }
+
+  /// @brief Runs the observer for the given amount of iterations and updates the real robot with its estimation.
+  /// @param beforeRun Called before each run of the observer with the index of the iteration.
+  /// @return false if the observer failed.
+  bool run(size_t nbIter, const std::function<void(size_t)> & beforeRun = {})
+  {
+    for(size_t i = 0; i < nbIter; ++i)
+    {
+      if(beforeRun) { beforeRun(i); }
+      if(!observer_->run(ctl_))
+      {
+        mc_rtc::log::critical("[{}] The observer failed at iteration {}", observer_->name(), i);
+        return false;
+      }
+      observer_->update(ctl_);
+    }
+    return true;
+  }
+
+  /// @brief Returns the computation times of the given stage of the run of the observer.
+  const profiling::LatencyHistogram & stageTimings(const std::string & stage)
+  {
+    const std::string entryName = observer_->name() + "::RunStageTimings::" + stage;
+    return ctl_.datastore().call<const profiling::LatencyHistogram &>(entryName);
+  }
+
+  /// @brief Returns the estimated position of the floating base.
+  Eigen::Vector3d fbPosition() const { return ctl_.realRobot().posW().translation(); }
+
+  KoModesController & ctl_;
+  std::shared_ptr<mc_observers::Observer> observer_;
+};
+
+/// @brief Loads the configuration of the tests, modified by each tested mode.
+mc_rtc::Configuration testConfiguration()
+{
+  return mc_rtc::Configuration(TEST_KO_MODES_CONFIG);
+}
+
+/// @brief Returns the position of the floating base estimated by the Kinetics Observer in the synchronous mode, to
+/// which the other modes are compared.
+/// @return std::nullopt if the observer failed.
+std::optional<Eigen::Vector3d> referencePosition(KoModesController & ctl, size_t nbIter)
+{
+  KoUnderTest ko(ctl, "MCKineticsObserverReference", testConfiguration());
+  if(!ko.run(nbIter)) { return std::nullopt; }
+  return ko.fbPosition();
+}
+
+/// @brief Checks that an estimated position of the floating base is close to the reference one.
+bool checkPosition(const Eigen::Vector3d & position, const Eigen::Vector3d & reference, double tolerance)
+{
+  if((position - reference).norm() <= tolerance) { return true; }
+  mc_rtc::log::critical("The estimated position of the floating base ({}) differs from the reference ({}) by more than "
+                        "{} m",
+                        position.transpose(), reference.transpose(), tolerance);
+  return false;
+}
+
+/// @brief The update of the Kinetics Observer runs on a worker thread, its results are used on the next iteration
+/// and compensated for this delay of one iteration.
+bool checkAsyncUpdate(KoModesController & ctl)
+{
+  const size_t nbIter = 400;
+  const auto reference = referencePosition(ctl, nbIter);
+  if(!reference) { return false; }
+
+  auto config = testConfiguration();
+  config.add("asyncUpdate", true);
+  KoUnderTest ko(ctl, "MCKineticsObserver", config);
+  if(!ko.run(nbIter)) { return false; }
+
+  const double latency = ctl.datastore().call<double>("MCKineticsObserver::EstimationLatency");
+  if(std::abs(latency - ctl.timeStep) > 1e-9)
+  {
+    mc_rtc::log::critical("The estimation latency is {} s instead of one iteration ({} s)", latency, ctl.timeStep);
+    return false;
+  }
+  // the update triggered on the last iteration may still be running
+  if(ko.stageTimings("ekfUpdate").count() < nbIter - 1)
+  {
+    mc_rtc::log::critical("The Kinetics Observer was updated only {} times over {} iterations",
+                          ko.stageTimings("ekfUpdate").count(), nbIter);
+    return false;
+  }
+  return checkPosition(ko.fbPosition(), *reference, 5e-3);
+}
+
+/// @brief The absolute pose measurements received with a delay are transported to the current iteration with the
+/// displacement estimated since they were taken, and correct the estimation.
+bool checkDelayedPose(KoModesController & ctl)
+{
+  const size_t nbIter = 400;
+  // the history of the estimation must contain the iteration of the measurement
+  const size_t firstMeasurementIter = 10;
+  const unsigned long delay = 5;
+
+  auto config = testConfiguration();
+  // the position of the robot and of its contacts is uncertain so it can be corrected by the measurements
+  auto ekfStateProcessVariances = config("ekfStateProcessVariances");
+  ekfStateProcessVariances.add("statePositionInitVariance", Eigen::Vector3d::Constant(1e-2));
+  ekfStateProcessVariances.add("contactPositionInitVarianceFirstContacts", Eigen::Vector3d::Constant(1e-2));
+  auto ekfSensorNoiseVariances = config("ekfSensorNoiseVariances");
+  ekfSensorNoiseVariances.add("positionSensorVariance", Eigen::Vector3d::Constant(1e-6));
+  ekfSensorNoiseVariances.add("orientationSensorVariance", Eigen::Vector3d::Constant(1e-6));
+  KoUnderTest ko(ctl, "MCKineticsObserver", config);
+
+  // the robot stands still, so the measured pose is the same on all the iterations
+  sva::PTransformd measuredPose = ctl.realRobot().posW();
+  measuredPose.translation().x() += 0.02;
+  auto giveMeasurement = [&ctl, &measuredPose, firstMeasurementIter, delay](size_t i)
+  {
+    if(i < firstMeasurementIter) { return; }
+    ctl.datastore().call<void, const sva::PTransformd &, unsigned long, bool>(
+        "MCKineticsObserver::DelayedAbsolutePose", measuredPose, delay, true);
+  };
+  if(!ko.run(nbIter, giveMeasurement)) { return false; }
+
+  // the measurements are much more accurate than the initial estimation
+  return checkPosition(ko.fbPosition(), measuredPose.translation(), 1e-2);
+}
+
+/// @brief The Kinetics Observer is updated only once every ekfUpdatePeriod iterations, the floating base being
+/// propagated with the Tilt Observer in between.
+bool checkMultiRate(KoModesController & ctl)
+{
+  const size_t nbIter = 400;
+  const size_t ekfUpdatePeriod = 4;
+  const auto reference = referencePosition(ctl, nbIter);
+  if(!reference) { return false; }
+
+  auto config = testConfiguration();
+  config.add("ekfUpdatePeriod", ekfUpdatePeriod);
+  KoUnderTest ko(ctl, "MCKineticsObserver", config);
+  if(!ko.run(nbIter)) { return false; }
+
+  if(ko.stageTimings("ekfUpdate").count() != nbIter / ekfUpdatePeriod)
+  {
+    mc_rtc::log::critical("The Kinetics Observer was updated {} times over {} iterations instead of {}",
+                          ko.stageTimings("ekfUpdate").count(), nbIter, nbIter / ekfUpdatePeriod);
+    return false;
+  }
+  return checkPosition(ko.fbPosition(), *reference, 5e-3);
+}
+
+/// @brief An update of the Kinetics Observer is skipped if the previous one exceeded the time budget, the floating base
+/// being propagated with the Tilt Observer instead.
+bool checkTimeBudget(KoModesController & ctl)
+{
+  const size_t nbIter = 400;
+  const auto reference = referencePosition(ctl, nbIter);
+  if(!reference) { return false; }
+
+  auto config = testConfiguration();
+  // all the updates exceed the budget, so every update is followed by a skipped one
+  config.add("ekfTimeBudget", 1e-9);
+  KoUnderTest ko(ctl, "MCKineticsObserver", config);
+  if(!ko.run(nbIter)) { return false; }
+
+  if(ko.stageTimings("ekfUpdate").count() != nbIter / 2)
+  {
+    mc_rtc::log::critical("The Kinetics Observer was updated {} times over {} iterations instead of {}",
+                          ko.stageTimings("ekfUpdate").count(), nbIter, nbIter / 2);
+    return false;
+  }
+  return checkPosition(ko.fbPosition(), *reference, 1e-2);
+}
+
+/// @brief The state saved to the checkpoint file when the observer is destroyed is restored on the next reset, the
+/// estimation continuing from the pose of the previous run instead of the initial pose of the robot.
+bool checkCheckpoint(KoModesController & ctl)
+{
+  const size_t nbIter = 200;
+  const std::string checkpointFile = (std::filesystem::temp_directory_path() / "Test_KoModes.checkpoint").string();
+  std::filesystem::remove(checkpointFile);
+
+  auto config = testConfiguration();
+  config.add("checkpointFile", checkpointFile);
+
+  Eigen::Vector3d savedPosition;
+  {
+    KoUnderTest ko(ctl, "MCKineticsObserver", config);
+    if(!ko.run(nbIter)) { return false; }
+    savedPosition = ko.fbPosition();
+  }
+  if(!std::filesystem::exists(checkpointFile))
+  {
+    mc_rtc::log::critical("The checkpoint file {} was not written when the observer was destroyed", checkpointFile);
+    return false;
+  }
+
+  // the robot starts the next run from another pose, which is ignored by the warm start
+  sva::PTransformd initPose = ctl.robot().posW();
+  initPose.translation().x() += 0.5;
+  ctl.robots().robot().posW(initPose);
+
+  KoUnderTest ko(ctl, "MCKineticsObserver", config);
+  const bool success = ko.run(10);
+  std::filesystem::remove(checkpointFile);
+  return success && checkPosition(ko.fbPosition(), savedPosition, 1e-2);
+}
+
+/// @brief The transitions of the contacts are polled from the event stream published in the datastore, as a consumer
+/// outside the real-time loop would. The right foot is lifted and put down again while the left one stays on the
+/// ground.
+bool checkContactEvents(KoModesController & ctl)
+{
+  using ContactEvent = measurements::ContactEvent;
+
+  const size_t liftIter = 50;
+  const size_t landingIter = 100;
+  const size_t nbIter = 150;
+
+  KoUnderTest ko(ctl, "MCKineticsObserver", testConfiguration());
+  const auto & contactEvents =
+      ctl.datastore().call<const measurements::ContactEvents &>("MCKineticsObserver::ContactEvents");
+
+  const double halfWeight = ctl.robot().mass() * stateObservation::cst::gravityConstant / 2;
+  auto setRightFootForce = [&ctl, halfWeight, liftIter, landingIter](size_t i)
+  {
+    if(i != liftIter && i != landingIter) { return; }
+    const double force = i == liftIter ? 0.0 : halfWeight;
+    for(auto * robot : {&ctl.robots().robot(), &ctl.realRobots().robot()})
+    {
+      const_cast<mc_rbdyn::ForceSensor &>(robot->forceSensor("RightFootForceSensor"))
+          .wrench(sva::ForceVecd(Eigen::Vector3d::Zero(), Eigen::Vector3d(0.0, 0.0, force)));
+    }
+  };
+  if(!ko.run(nbIter, setRightFootForce)) { return false; }
+
+  // the contacts are added on the configuration of the observer, which is read from the beginning of the stream
+  uint64_t cursor = 0;
+  uint64_t missed = 0;
+  ContactEvent event;
+  std::vector<ContactEvent> events;
+  while(contactEvents.poll(cursor, event, &missed)) { events.push_back(event); }
+  if(missed != 0)
+  {
+    mc_rtc::log::critical("{} contact events were missed", missed);
+    return false;
+  }
+
+  // the ids of the contacts follow the order of surfacesForContactDetection: right foot, then left foot. The ticks
+  // count the updates of the contacts, starting from 1 on the first iteration.
+  const unsigned rightFoot = 0;
+  const unsigned leftFoot = 1;
+  const std::vector<std::tuple<uint64_t, unsigned, ContactEvent::Type>> expectedEvents = {
+      {0, rightFoot, ContactEvent::Type::Added},
+      {0, leftFoot, ContactEvent::Type::Added},
+      {1, rightFoot, ContactEvent::Type::New},
+      {1, leftFoot, ContactEvent::Type::New},
+      {liftIter + 1, rightFoot, ContactEvent::Type::Removed},
+      {landingIter + 1, rightFoot, ContactEvent::Type::New}};
+
+  bool success = events.size() == expectedEvents.size();
+  for(size_t i = 0; success && i < events.size(); ++i)
+  {
+    const auto & [tick, contactId, type] = expectedEvents[i];
+    success = events[i].tick == tick && events[i].contactId == contactId && events[i].type == type;
+  }
+  if(!success)
+  {
+    mc_rtc::log::critical("The stream contains {} contact events instead of the {} expected ones:", events.size(),
+                          expectedEvents.size());
+    for(const auto & e : events)
+    {
+      mc_rtc::log::critical("  tick {}: contact {}, type {}, force {} N", e.tick, e.contactId,
+                            static_cast<int>(e.type), e.forceNorm);
+    }
+    return false;
+  }
+
+  // the removal is triggered by the force falling below the lower threshold of the Schmitt trigger
+  const ContactEvent & removal = events[4];
+  if(removal.forceNorm >= removal.schmittTrigger.lowerThreshold)
+  {
+    mc_rtc::log::critical("The right foot was removed with a force of {} N, above the lower threshold ({} N)",
+                          removal.forceNorm, removal.schmittTrigger.lowerThreshold);
+    return false;
+  }
+  return true;
+}
+
+} // namespace mc_state_observation
+
+int main(int argc, char * argv[])
+{
+  using namespace mc_state_observation;
+
+  const std::map<std::string, bool (*)(KoModesController &)> modes = {{"async", checkAsyncUpdate},
+                                                                      {"delayedPose", checkDelayedPose},
+                                                                      {"multiRate", checkMultiRate},
+                                                                      {"timeBudget", checkTimeBudget},
+                                                                      {"checkpoint", checkCheckpoint},
+                                                                      {"contactEvents", checkContactEvents}};
+
+  if(argc != 2 || modes.count(argv[1]) == 0)
+  {
+    mc_rtc::log::critical("Usage: {} <mode>, see the list of the modes at the top of test_ko_modes.cpp", argv[0]);
+    return 1;
+  }
+
+  const double dt = 0.005;
+  auto rm = mc_rbdyn::RobotLoader::get_robot_module("JVRC1");
+  KoModesController ctl(rm, dt);
+
+  mc_observers::ObserverLoader::clear();
+  mc_observers::ObserverLoader::append_path({TEST_KO_MODES_MODULE_PATH});
+
+  if(!modes.at(argv[1])(ctl)) { return 1; }
+
+  mc_rtc::log::success("The {} mode of the Kinetics Observer behaves as expected", argv[1]);
+  return 0;
+}